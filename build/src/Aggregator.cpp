@@ -4,80 +4,153 @@
 #include <vector>
 #include <string>
 #include <ctime>
+#include <cstdint>
 #include <map>
 #include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/Status.h>
 #include "include/Aggregator.h"
+#include "include/AllJoynTransport.h"
+#include "include/LoopbackTransport.h"
 #include "include/logger.h"
+#include "include/LogWriter.h"
 
 // constructor
-// - simply initialize member properties
-Aggregator::Aggregator (tsu::config_map &init) :
+// - initialize member properties and start the command pipeline with the
+// - transport from the dispatch configuration
+Aggregator::Aggregator (tsu::config_map &init, TimeSource* clock) :
 	config_(init),
+	clock_(clock),
 	last_log_(0),
 	log_inc_(stoul(init["Logger"]["increment"])),
 	log_path_(init["Logger"]["path"]),
+	log_binary_(init["Logger"]["format"] == "binary"),
+	next_key_(0),
+	index_(&fleet_),
 	total_export_energy_(0),
 	total_export_power_(0),
 	total_import_energy_(0),
 	total_import_power_(0),
+	export_power_(0),
+	import_power_(0),
 	export_watts_(0),
 	import_watts_(0),
 	price_(0),
 	time_(0),
 	temperature_(0) {
-	// do nothing
+	std::map <std::string, std::string>& dispatch = init["Dispatch"];
+	if (dispatch["transport"] == "loopback") {
+		transport_.reset (new LoopbackTransport (
+			stoul(dispatch["loopback_endpoints"]),
+			stoul(dispatch["loopback_latency"]),
+			stoul(dispatch["loopback_jitter"]),
+			stod(dispatch["loopback_loss"])
+		));
+	} else {
+		transport_.reset (new AllJoynTransport (
+			init["AllJoyn"]["client_interface"],
+			stoul(dispatch["reply_timeout"])
+		));
+	}
+	queue_.reset (new CommandQueue (transport_.get (),
+									stoul(dispatch["workers"]),
+									stoul(dispatch["timeout"])));
+
+	Metrics& metrics = Metrics::Instance ();
+	const char* dispatch_help = "Aggregator dispatch phase time.";
+	actions_ = &metrics.GetCounter ("deras_control_actions_total",
+		"Control actions applied from the control channel.",
+		"owner=\"aggregator\"");
+	twins_time_ = &metrics.GetHistogram ("deras_dispatch_seconds",
+		dispatch_help, "phase=\"twins\"");
+	totals_time_ = &metrics.GetHistogram ("deras_dispatch_seconds",
+		dispatch_help, "phase=\"totals\"");
+	filter_time_ = &metrics.GetHistogram ("deras_dispatch_seconds",
+		dispatch_help, "phase=\"filter\"");
+	export_time_ = &metrics.GetHistogram ("deras_dispatch_seconds",
+		dispatch_help, "phase=\"export\"");
+	import_time_ = &metrics.GetHistogram ("deras_dispatch_seconds",
+		dispatch_help, "phase=\"import\"");
+	resource_count_ = &metrics.GetGauge ("deras_resources",
+		"Resources in the fleet.");
+	export_gauge_ = &metrics.GetGauge ("deras_dispatch_watts",
+		"Dispatch watts for the target resources.", "direction=\"export\"");
+	import_gauge_ = &metrics.GetGauge ("deras_dispatch_watts",
+		"Dispatch watts for the target resources.", "direction=\"import\"");
+	pending_gauge_ = &metrics.GetGauge ("deras_command_pending",
+		"Resources with a command waiting to send.");
+	in_flight_gauge_ = &metrics.GetGauge ("deras_command_in_flight",
+		"Resources with a command waiting on completion.");
 }  // end constructor
 
+// destructor
+// - the workers are stopped before the transport so no command is sent to a
+// - deleted transport, then the transport is deleted before the queue so
+// - no completion is called on a deleted queue
 Aggregator::~Aggregator () {
-	// do nothing
+	queue_->Stop ();
+	transport_.reset ();
+	queue_.reset ();
 }  // end destructor
 
 // Set Targets
 // - store the new target arguments and then filter the current resources
 void Aggregator::SetTargets (const std::vector <std::string> &targets) {
-	targets_ = targets;
-	Aggregator::FilterResources ();
+	channel_.Post ([this, targets] {
+		// the operator sets the same targets on every signal
+		if (targets == targets_) {
+			return;
+		}
+		targets_ = targets;
+		Aggregator::FilterResources ();
+	});
 }  // end Set Targets
 
 // Set Export Watts
 // - set the dispatch watts for DER to export to the grid
 void Aggregator::SetExportWatts (unsigned int power) {
-	import_watts_ = 0;
-	if (power > total_export_power_) {
-		export_watts_ = total_export_power_;
-	} else {
-		export_watts_ = power;
-	}
+	channel_.Post ([this, power] {
+		import_watts_ = 0;
+		if (power > total_export_power_) {
+			export_watts_ = total_export_power_;
+		} else {
+			export_watts_ = power;
+		}
+	});
 }  // end Set Export Watts
 
 // Set Import Watts
 // - set the dispatch watts for DER to import from the grid
 void Aggregator::SetImportWatts (unsigned int power) {
-	export_watts_ = 0;
-	if (power > total_import_power_) {
-		import_watts_ = total_import_power_;
-	} else {
-		import_watts_ = power;
-	}
+	channel_.Post ([this, power] {
+		export_watts_ = 0;
+		if (power > total_import_power_) {
+			import_watts_ = total_import_power_;
+		} else {
+			import_watts_ = power;
+		}
+	});
 }  // end Set Import Watts
 
 // Set Price
 // - the tenths of a cent per kWh
 void Aggregator::SetPrice (int price) {
-	price_ = price;
+	channel_.Post ([this, price] {
+		price_ = price;
+	});
 }  // end Set Price
 
 // Set Temperature
 // - Set the local temperature in F
 void Aggregator::SetTemperature (int temperature) {
-	temperature_ = temperature;
+	channel_.Post ([this, temperature] {
+		temperature_ = temperature;
+	});
 }  // end Set Temperature
 
 // Set Time
 // - the UTC time as seconds from epoch
 void Aggregator::SetTime () {
-	unsigned int utc = time (nullptr);
+	unsigned int utc = clock_->Now ();
 	bool half_hour = utc % (60*30) == 0;
 	// update time every hour
 	if (half_hour) {
@@ -109,6 +182,30 @@ unsigned int Aggregator::GetTotalImportPower () {
     return total_import_power_;
 }  // end Get Total Import Power
 
+// Get Export Watts
+// - return the dispatch watts for the filtered resources to export
+unsigned int Aggregator::GetExportWatts () {
+	return export_watts_;
+}  // end Get Export Watts
+
+// Get Import Watts
+// - return the dispatch watts for the filtered resources to import
+unsigned int Aggregator::GetImportWatts () {
+	return import_watts_;
+}  // end Get Import Watts
+
+// Get Export Power
+// - return the digital twin Watts the filtered resources export
+float Aggregator::GetExportPower () {
+	return export_power_;
+}  // end Get Export Power
+
+// Get Import Power
+// - return the digital twin Watts the filtered resources import
+float Aggregator::GetImportPower () {
+	return import_power_;
+}  // end Get Import Power
+
 // Get Price
 // - return tenths of a cent per kWh for electricity
 int Aggregator::GetPrice () {
@@ -127,17 +224,65 @@ int Aggregator::GetTemperature () {
 	return temperature_;
 }  // end Get Temperature
 
+// Get Log Path
+// - return the logger path so the operator logs next to the data, it is
+// - read only and may be called from any thread
+std::string Aggregator::GetLogPath () {
+	return log_path_;
+}  // end Get Log Path
+
+// Get Command Stats
+// - return the command pipeline counters
+CommandStats Aggregator::GetCommandStats () {
+	return queue_->GetStats ();
+}  // end Get Command Stats
+
 // Add Resource
 // - This is used by the Client Listener class to add newly discovered DER.
-// - it also passes the AllJoyn Proxy Bus Object that will be used to control
-// - individual DER when desired
+// - it also passes the AllJoyn Proxy Bus Object that the command transport
+// - will use to control individual DER when desired. The proxy is
+// - registered right away since it only lives for the listener callback.
 void Aggregator::AddResource (
 	std::map <std::string, unsigned int>& init,
 	ajn::ProxyBusObject &proxy) {
-	std::string interface = config_["AllJoyn"]["client_interface"];
+	unsigned long key = next_key_++;
+	transport_->Register (key, proxy);
+	std::string uid = proxy.GetUniqueName ();
+	std::string path = proxy.GetPath ();
+	channel_.Post ([this, init, key, uid, path] () mutable {
+		Aggregator::InsertResource (init, key, uid, path);
+	});
+}  // end Add Resource
+
+// Add Resource
+// - add a resource without a proxy bus object. The offline simulator uses
+// - this with the loopback transport.
+void Aggregator::AddResource (
+	std::map <std::string, unsigned int>& init,
+	const std::string& uid,
+	const std::string& path) {
+	unsigned long key = next_key_++;
+	channel_.Post ([this, init, key, uid, path] () mutable {
+		Aggregator::InsertResource (init, key, uid, path);
+	});
+}  // end Add Resource
+
+// Insert Resource
+// - create the digital twin in the fleet state and add it to the lookups
+void Aggregator::InsertResource (
+	std::map <std::string, unsigned int>& init,
+	unsigned long key,
+	const std::string& uid,
+	const std::string& path) {
+	unsigned int id = fleet_.Add (init);
 	std::shared_ptr <DistributedEnergyResource> 
-		der (new DistributedEnergyResource (init, proxy, interface));
-	Logger("Property", log_path_)
+		der (new DistributedEnergyResource (&fleet_,
+											id,
+											queue_.get (),
+											key,
+											uid,
+											path));
+	Logger("Property", log_path_, clock_->Now ())
 		<< der->GetUID () << '\t'
 		<< der->GetPath () << '\t'
 		<< der->GetExportRamp () << '\t'
@@ -146,20 +291,35 @@ void Aggregator::AddResource (
 		<< der->GetImportRamp () << '\t'
 		<< der->GetRatedImportPower () << '\t'
 		<< der->GetRatedImportEnergy () << '\t'
-		<< der->GetIdleLosses ();
+		<< der->GetIdleLosses () << '\t'
+		<< der->GetKey ();
 	der->RemoteImportPower (0);
+	uids_.emplace (der->GetUID (), id);
+	groups_.Add (der->GetPath ());
+	if (groups_.IsMember (id, targets_)) {
+		fleet_.target[id] = 1;
+		index_.Insert (der.get ());
+	}
 	resources_.push_back (std::move (der));
-	Aggregator::FilterResources ();
-}  // end Add Resource
+}  // end Insert Resource
 
 // Update Resource
-// - when the Client Listener gets a property update signal it will look for the
-// - correct resource and update it's properties
+// - when the Client Listener gets a property update signal it will look up the
+// - correct resource by UID and update it's properties
 void Aggregator::UpdateResource (std::map <std::string, unsigned int>& init,
 				 				 const std::string& uid) {
-	bool found = false;
-	for (auto& resource : resources_) {
-		if (resource->GetUID() == uid) {
+	channel_.Post ([this, init, uid] () mutable {
+		auto range = uids_.equal_range (uid);
+		if (range.first == range.second) {
+			std::cout 
+				<< "Property update signal recieved from unknown resource!" 
+				<< std::endl;
+			return;
+		}
+
+		for (auto it = range.first; it != range.second; it++) {
+			std::shared_ptr <DistributedEnergyResource> resource
+				= resources_[it->second];
 			resource->SetRatedExportEnergy (init["rated_export_energy"]);
 			resource->SetRatedExportPower (init["rated_export_power"]);
 			resource->SetExportEnergy (init["export_energy"]);
@@ -171,223 +331,273 @@ void Aggregator::UpdateResource (std::map <std::string, unsigned int>& init,
 			resource->SetImportPower (init["import_power"]);
 			resource->SetImportRamp (init["import_ramp"]);
 			resource->SetIdleLosses (init["idle_losses"]);
-			found = true;
-		} 
-	}
-
-	if (found) {
-		// do nothing
-	} else {
-		std::cout 
-			<< "Property update signal recieved from unknown resource!" 
-			<< std::endl;
-	}
+			index_.Update (resource.get ());
+		}
+	});
 }  // end Update Resource
 
 // Remove Resource
 // - if the Client Listener recieves a object loss signal then it will remove
-// - it from the resource list
+// - every resource owned by the UID from the resource list
 void Aggregator::RemoveResource (const std::string& uid) {
-    // (TS): unlike a normal for loop, this loops iterator must be
-    //       incremented only if the element is not deleted or you get
-    //       memory leaks.
-    for (auto it = resources_.begin(); it != resources_.end();) {
-        if ((*it)->GetUID ().find(uid) != std::string::npos) {
-            it = resources_.erase (it);
-        } else {
-            it++;
+	channel_.Post ([this, uid] {
+		auto found = uids_.find (uid);
+		while (found != uids_.end ()) {
+			Aggregator::RemoveAt (found->second);
+			found = uids_.find (uid);
+		}
+	});
+}  // end Remove Resource
+
+// Remove At
+// - remove the resource at the fleet id. The last resource takes its id so
+// - the fleet state stays dense.
+void Aggregator::RemoveAt (unsigned int id) {
+    std::shared_ptr <DistributedEnergyResource> der = resources_[id];
+    index_.Erase (der.get ());
+    Aggregator::EraseUID (der->GetUID (), id);
+    queue_->Cancel (der->GetKey ());
+    transport_->Unregister (der->GetKey ());
+
+    unsigned int last = resources_.size () - 1;
+    fleet_.Remove (id);
+    groups_.Remove (id);
+    if (id != last) {
+        std::shared_ptr <DistributedEnergyResource> moved = resources_[last];
+        index_.Erase (moved.get ());
+        Aggregator::EraseUID (moved->GetUID (), last);
+        moved->SetID (id);
+        uids_.emplace (moved->GetUID (), id);
+        resources_[id] = moved;
+        if (fleet_.target[id]) {
+            index_.Insert (moved.get ());
         }
     }
-    Aggregator::FilterResources ();
-}  // end Remove Resource
+    resources_.pop_back ();
+}  // end Remove At
+
+// Erase UID
+// - remove the UID entry that points at the fleet id
+void Aggregator::EraseUID (const std::string& uid, unsigned int id) {
+	auto range = uids_.equal_range (uid);
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second == id) {
+			uids_.erase (it);
+			return;
+		}
+	}
+}  // end Erase UID
 
 // Loop
 // - check the import and export watts to disptach remote devices and
 // - digital twins. also call the log function to log all discovered DER 
-// - properties
+// - properties. The dispatch index re-keys the twins whose energy may have
+// - left their bucket this tick, reference DispatchIndex.
+// - the posted controls are applied first so this tick dispatches them.
 void Aggregator::Loop (float delta_time) {
-    // update all resources
-    for (auto &resource : resources_) {
-		resource->Loop (delta_time);
+    actions_->Add (channel_.Drain ());
+    // update all digital twins in one pass over the fleet state
+    {
+        MetricsTimer timer (*twins_time_);
+        fleet_.Loop (delta_time);
+        index_.Refresh (delta_time);
     }
 	Aggregator::UpdateTotals ();
 	Aggregator::ExportPower ();
 	Aggregator::ImportPower ();
 	Aggregator::Log ();
 	Aggregator::SetTime ();
+
+	CommandStats stats = queue_->GetStats ();
+	resource_count_->Set (resources_.size ());
+	export_gauge_->Set (export_watts_);
+	import_gauge_->Set (import_watts_);
+	pending_gauge_->Set (stats.pending);
+	in_flight_gauge_->Set (stats.in_flight);
 }  // end Loop
 
 // Log
-// - log all resource properties based on the set log increment.
-// - TODO (TS): I should write this function to write to file once instead of
-// - for each resource, but we will see how much of performance loss we have.
+// - log all resource properties based on the set log increment, an increment
+// - of zero turns the Data log off. The records
+// - are written by the background log writer. In binary format the whole
+// - fleet is written as one block, reference LogBinary.
 void Aggregator::Log () {
     // log resources based on elapsed time
-    unsigned int utc = time(0);
-    if (utc != last_log_ && utc % log_inc_ == 0) {
-	    for (const auto &resource : resources_) {
-			Logger("Data", log_path_)
-				<< resource->GetUID () << '\t'
-				<< resource->GetPath () << '\t'
-				<< resource->GetExportWatts () << '\t'
-				<< resource->GetExportPower () << '\t'
-				<< resource->GetExportEnergy () << '\t'
-				<< resource->GetImportWatts () << '\t'
-				<< resource->GetImportPower () << '\t'
-				<< resource->GetImportEnergy ();
-		    }
-			last_log_ = utc;
-	    }
-}
-
-void Aggregator::DisplayAllResources () {
-    std::cout << "\nAll Resources:" << std::endl;
+    unsigned int utc = clock_->Now ();
+    if (log_inc_ == 0 || utc == last_log_ || utc % log_inc_ != 0) {
+        return;
+    }
+    last_log_ = utc;
+    if (log_binary_) {
+        Aggregator::LogBinary (utc);
+        return;
+    }
     for (const auto &resource : resources_) {
-        resource->Print ();
+        Logger("Data", log_path_, utc)
+            << resource->GetUID () << '\t'
+            << resource->GetPath () << '\t'
+            << resource->GetExportWatts () << '\t'
+            << resource->GetExportPower () << '\t'
+            << resource->GetExportEnergy () << '\t'
+            << resource->GetImportWatts () << '\t'
+            << resource->GetImportPower () << '\t'
+            << resource->GetImportEnergy ();
+    }
+}  // end Log
+
+// Log Binary
+// - write the fleet state columns as one Data block. The resource key joins
+// - the rows with the Property log. Native byte order:
+//   char     magic[4]      "DERT"
+//   uint32   version       1
+//   int64    utc
+//   uint32   count
+//   uint64   key[count]
+//   uint32   export_watts[count]
+//   float    export_power[count], export_energy[count]
+//   uint32   import_watts[count]
+//   float    import_power[count], import_energy[count]
+void Aggregator::LogBinary (unsigned int utc) {
+    const uint32_t count = resources_.size ();
+    const uint32_t version = 1;
+    const int64_t time = utc;
+    std::vector <uint64_t> keys (count);
+    for (uint32_t id = 0; id < count; id++) {
+        keys[id] = resources_[id]->GetKey ();
     }
+
+    std::string block;
+    block.reserve (24 + count * (8 + 6 * 4));
+    auto append = [&block] (const void* data, size_t size) {
+        block.append (static_cast <const char*> (data), size);
+    };
+    append ("DERT", 4);
+    append (&version, sizeof (version));
+    append (&time, sizeof (time));
+    append (&count, sizeof (count));
+    append (keys.data (), count * sizeof (uint64_t));
+    append (fleet_.export_watts.data (), count * sizeof (unsigned int));
+    append (fleet_.export_power.data (), count * sizeof (float));
+    append (fleet_.export_energy.data (), count * sizeof (float));
+    append (fleet_.import_watts.data (), count * sizeof (unsigned int));
+    append (fleet_.import_power.data (), count * sizeof (float));
+    append (fleet_.import_energy.data (), count * sizeof (float));
+
+    LogWriter& writer = LogWriter::Instance ();
+    writer.PushBlock (writer.GetSink ("Data", log_path_, ".bin"),
+                      utc,
+                      std::move (block));
+}  // end Log Binary
+
+void Aggregator::DisplayAllResources () {
+    channel_.Post ([this] {
+        std::cout << "\nAll Resources:" << std::endl;
+        for (const auto &resource : resources_) {
+            resource->Print ();
+        }
+    });
 }
 
 void Aggregator::DisplayTargetResources () {
-    std::cout << "\nTarget Resources:" << std::endl;
-    for (const auto &resource : sub_resources_) {
-        resource->Print ();
-    }
+    channel_.Post ([this] {
+        std::cout << "\nTarget Resources:" << std::endl;
+        for (const auto &resource : resources_) {
+            if (fleet_.target[resource->GetID ()]) {
+                resource->Print ();
+            }
+        }
+    });
 }
 
+// Update Totals
+// - sum the target resources directly from the fleet state columns, the
+// - twin power is the response to the dispatch used by the simulator
 void Aggregator::UpdateTotals () {
-	total_export_energy_ = 0;
-	total_export_power_ = 0;
-	total_import_energy_ = 0;
-	total_import_power_ = 0;
-    for (const auto &resource : sub_resources_) {
-		total_export_energy_ += resource->GetExportEnergy ();
-		total_export_power_ += resource->GetRatedExportPower ();
-		total_import_energy_ += resource->GetImportEnergy ();
-		total_import_power_ += resource->GetRatedImportPower ();    	
-    }
+	MetricsTimer timer (*totals_time_);
+	const unsigned int size = fleet_.Size ();
+	const unsigned char* target = fleet_.target.data ();
+	const float* export_energy = fleet_.export_energy.data ();
+	const unsigned int* export_power = fleet_.rated_export_power.data ();
+	const float* import_energy = fleet_.import_energy.data ();
+	const unsigned int* import_power = fleet_.rated_import_power.data ();
+	const float* export_twin = fleet_.export_power.data ();
+	const float* import_twin = fleet_.import_power.data ();
+	unsigned int total_export_energy = 0;
+	unsigned int total_export_power = 0;
+	unsigned int total_import_energy = 0;
+	unsigned int total_import_power = 0;
+	float twin_export_power = 0;
+	float twin_import_power = 0;
+	for (unsigned int i = 0; i < size; i++) {
+		unsigned int mask = target[i] ? ~0u : 0u;
+		total_export_energy += (unsigned int)export_energy[i] & mask;
+		total_export_power += export_power[i] & mask;
+		total_import_energy += (unsigned int)import_energy[i] & mask;
+		total_import_power += import_power[i] & mask;
+		twin_export_power += target[i] ? export_twin[i] : 0.0f;
+		twin_import_power += target[i] ? import_twin[i] : 0.0f;
+	}
+	total_export_energy_ = total_export_energy;
+	total_export_power_ = total_export_power;
+	total_import_energy_ = total_import_energy;
+	total_import_power_ = total_import_power;
+	export_power_ = twin_export_power;
+	import_power_ = twin_import_power;
 }
 
-void Aggregator::DisplaySummary () {
-    std::cout << "\nAggregated Properties:"
-    << "\n\tResource Count = " << resources_.size()
-		<< "\n\tTotal Export Energy = " << total_export_energy_
-		<< "\n\tTotal Export Power = " << total_export_power_
-		<< "\n\tTotal Import Energy = " << total_import_energy_
-		<< "\n\tTotal Import Power = " << total_import_power_ << std::endl;
+// Display Summary
+// - print the totals and the command queue on the scheduler thread, then
+// - run the next action
+void Aggregator::DisplaySummary (ControlChannel::Action next) {
+    channel_.Post ([this, next] {
+        std::cout << "\nAggregated Properties:"
+        << "\n\tResource Count = " << resources_.size()
+            << "\n\tTotal Export Energy = " << total_export_energy_
+            << "\n\tTotal Export Power = " << total_export_power_
+            << "\n\tTotal Import Energy = " << total_import_energy_
+            << "\n\tTotal Import Power = " << total_import_power_ << std::endl;
+        queue_->DisplaySummary ();
+        if (next) {
+            next ();
+        }
+    });
 }
 
 // Filter Resources
-// - filter resources by target arguments.
+// - filter resources by target arguments using the target groups and only
+// - update the dispatch index for resources that changed membership.
 // - if target arguments is empty, then default to all resources
 void Aggregator::FilterResources () {
-    sub_resources_.clear();
-    if (targets_.size() == 0) {
-    	sub_resources_ = resources_;
-    } else {
-	    for (const auto &resource : resources_) {
-	        bool found;
-	        for (unsigned int i = 0; i < targets_.size(); i++) {
-	            if (resource->GetPath().find(targets_[i])!= std::string::npos) {
-	                found = true;
-	            } else {
-	                found = false;
-	                break;
-	            }
-	        }
-	        if (found) {
-	            sub_resources_.push_back(resource);
-	        }
-	    }	
+    MetricsTimer timer (*filter_time_);
+    std::vector <unsigned char> mask;
+    groups_.Match (targets_, mask);
+    for (unsigned int id = 0; id < resources_.size (); id++) {
+        if (mask[id] == fleet_.target[id]) {
+            continue;
+        }
+        fleet_.target[id] = mask[id];
+        if (mask[id]) {
+            index_.Insert (resources_[id].get ());
+        } else {
+            index_.Erase (resources_[id].get ());
+        }
     }
-}
+}  // end Filter Resources
 
 // Export Power
-// - loop through target resources and send export signal based on greatest
-// - export energy available. The signal sets both the "digital twin" and the 
-// - remote devices control watts;
+// - send export signal to target resources based on greatest ramp and then
+// - export energy available. The signal sets both the "digital twin" and the
+// - remote devices control watts. Reference DispatchIndex.
 void Aggregator::ExportPower () {
-	// sort by ramp first then export energy
-    std::sort(
-    	sub_resources_.begin(),sub_resources_.end(), [] (
-	const std::shared_ptr <DistributedEnergyResource> lhs,
-	const std::shared_ptr <DistributedEnergyResource> rhs) {
-		// ramp rate check
-		if (lhs->GetExportRamp () != rhs->GetExportRamp ()) {
-			return (lhs->GetExportRamp () > rhs->GetExportRamp ());
-		}
-
-		// energy check
-		return (lhs->GetExportEnergy () > rhs->GetExportEnergy ());
-	});
-
-    unsigned int dispatch_power = export_watts_;
-    unsigned int power = 0;
-    for (auto &resource : sub_resources_) {
-		if (dispatch_power > 0) {
-			power = resource->GetRatedExportPower ();
-		    if (resource->GetExportPower () == 0 
-		    	&& resource->GetExportWatts () == 0) {
-		   		// AllJoyn Method Call and digital twin
-			    resource->RemoteExportPower (power);
-		    }
-		    // subtract resources power from dispatch power
-		    if (dispatch_power > power) {
-		    	dispatch_power -= power;
-		    } else {
-		   		dispatch_power = 0;
-		    }
-		// once dispatch has been met tell other resources to stop exporting
-		} else {
-		    if (resource->GetExportWatts () != 0) {
-			    // AllJoyn Method Call
-			    resource->RemoteExportPower (0);
-		    }
-		}
-    }
+	MetricsTimer timer (*export_time_);
+	index_.ExportPower (export_watts_);
 }  // end Export Power
 
 // Import Power
-// - loop through target resources and send import signal based on greatest
-// - import energy available. The signal sets both the "digital twin" and the 
-// - remote devices control watts;
+// - send import signal to target resources based on greatest ramp and then
+// - import energy available. The signal sets both the "digital twin" and the
+// - remote devices control watts. Reference DispatchIndex.
 void Aggregator::ImportPower () {
-	// sort by ramp first then by import power
-    std::sort(
-    	sub_resources_.begin(),sub_resources_.end(), [] (
-		const std::shared_ptr <DistributedEnergyResource> lhs,
-		const std::shared_ptr <DistributedEnergyResource> rhs) {
-		// ramp rate check
-		if (lhs->GetImportRamp () != rhs->GetImportRamp ()) {
-			return (lhs->GetImportRamp () > rhs->GetImportRamp ());
-		}
-
-		// energy check
-		return (lhs->GetImportEnergy () > rhs->GetImportEnergy ());
-	});
-
-    unsigned int dispatch_power = import_watts_;
-    unsigned int power = 0;
-    for (auto &resource : sub_resources_) {
-		if (dispatch_power > 0) {
-			power = resource->GetRatedImportPower ();
-		    if (resource->GetImportPower () == 0
-		    	&& resource->GetImportWatts () == 0) {
-			    // AllJoyn Method Call and digital twin
-			    resource->RemoteImportPower (power);
-		    }
-
-		    // subtract resources power from dispatch power
-		    if (dispatch_power > power) {
-		    	dispatch_power -= power;
-		    } else {
-		   		dispatch_power = 0;
-		    }
-		// once dispatch has been met tell other resources to stop importing
-		} else {
-		    if (resource->GetImportWatts () != 0) {
-			    // AllJoyn Method Call
-			    resource->RemoteImportPower (0);
-		    }
-		}
-    }
+	MetricsTimer timer (*import_time_);
+	index_.ImportPower (import_watts_);
 }  // end Import Power
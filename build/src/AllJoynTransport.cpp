@@ -0,0 +1,134 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <alljoyn/Status.h>
+#include "include/AllJoynTransport.h"
+
+// time past the reply timeout to wait for the alljoyn timeout errors
+static const std::chrono::milliseconds kReplyGrace (1000);
+
+// constructor
+// - the reply timeout is in milliseconds
+AllJoynTransport::AllJoynTransport (const std::string& interface,
+                                    unsigned int reply_timeout)
+    : interface_(interface), reply_timeout_(reply_timeout), replying_(0) {
+    // do nothing
+}  // end constructor
+
+// destructor
+// - alljoyn answers every pending call with its reply or a timeout error so
+// - wait for them. Calls that are still pending after the reply timeout
+// - were dropped by a stopped bus, their commands are failed and freed.
+AllJoynTransport::~AllJoynTransport () {
+    std::vector <DoneHandler*> dropped;
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        drained_cv_.wait_for (lock,
+            std::chrono::milliseconds (reply_timeout_) + kReplyGrace,
+            [this] {
+                return pending_.empty () && replying_ == 0;
+            }
+        );
+        drained_cv_.wait (lock, [this] {
+            return replying_ == 0;
+        });
+        dropped.assign (pending_.begin (), pending_.end ());
+        pending_.clear ();
+    }
+    for (auto done : dropped) {
+        (*done) (false);
+        delete done;
+    }
+}  // end destructor
+
+// Register
+// - keep a copy of the proxy bus object for the resource
+void AllJoynTransport::Register (unsigned long resource,
+                                 ajn::ProxyBusObject &proxy) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    proxies_[resource] = proxy;
+}  // end Register
+
+// Unregister
+void AllJoynTransport::Unregister (unsigned long resource) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    proxies_.erase (resource);
+}  // end Unregister
+
+// Send
+// - call the ExportPower or ImportPower method of the remote device
+void AllJoynTransport::Send (const Command& command, DoneHandler done) {
+    ajn::ProxyBusObject proxy;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        auto found = proxies_.find (command.resource);
+        if (found == proxies_.end ()) {
+            done (false);
+            return;
+        }
+        proxy = found->second;
+    }
+
+    const char* method = (command.method == Command::EXPORT_POWER)
+                         ? "ExportPower" : "ImportPower";
+    ajn::MsgArg arg ("u", command.watts);
+    QStatus status;
+    if (reply_timeout_ == 0) {
+        // opted in to control signals without a reply
+        status = proxy.MethodCall (interface_.c_str (),
+                                   method,
+                                   &arg,
+                                   1,
+                                   ajn::ALLJOYN_FLAG_NO_REPLY_EXPECTED
+        );
+        done (status == ER_OK);
+        return;
+    }
+
+    // the handler is owned by the pending call until Reply
+    DoneHandler* context = new DoneHandler (std::move (done));
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        pending_.insert (context);
+    }
+    status = proxy.MethodCallAsync (
+        interface_.c_str (),
+        method,
+        this,
+        static_cast <ajn::MessageReceiver::ReplyHandler>
+            (&AllJoynTransport::Reply),
+        &arg,
+        1,
+        context,
+        reply_timeout_
+    );
+    if (status != ER_OK) {
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            pending_.erase (context);
+        }
+        (*context) (false);
+        delete context;
+    }
+}  // end Send
+
+// Reply
+// - alljoyn calls this with the method reply or an error, including the
+// - reply timeout. The handler is run without the lock and the destructor
+// - waits for it through replying_.
+void AllJoynTransport::Reply (ajn::Message& message, void* context) {
+    DoneHandler* done = static_cast <DoneHandler*> (context);
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (pending_.erase (done) == 0) {
+            return;  // already failed by the destructor
+        }
+        replying_++;
+    }
+    (*done) (message->GetType () != ajn::MESSAGE_ERROR);
+    delete done;
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    replying_--;
+    drained_cv_.notify_all ();
+}  // end Reply
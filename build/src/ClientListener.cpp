@@ -28,6 +28,13 @@ ClientListener::ClientListener(
                                obs_ptr_(obs),
                                vpp_ptr_(vpp),
                                client_interface_(client_name){
+    Metrics& metrics = Metrics::Instance ();
+    discovered_ = &metrics.GetCounter ("deras_listener_events_total",
+        "AllJoyn observer and property events.", "event=\"discovered\"");
+    lost_ = &metrics.GetCounter ("deras_listener_events_total",
+        "AllJoyn observer and property events.", "event=\"lost\"");
+    changed_ = &metrics.GetCounter ("deras_listener_events_total",
+        "AllJoyn observer and property events.", "event=\"changed\"");
 } // end ClientListener
 
 // ObjectDiscovered
@@ -38,6 +45,7 @@ void ClientListener::ObjectDiscovered (ajn::ProxyBusObject& proxy) {
     std::string path = proxy.GetPath();
     std::string service_name = proxy.GetServiceName();
     std::string name = proxy.GetUniqueName ();
+    discovered_->Add ();
 
     std::cout << "\n[LISTENER]\n";
     std::cout << "\tPath = " << path << '\n';
@@ -66,10 +74,11 @@ void ClientListener::ObjectDiscovered (ajn::ProxyBusObject& proxy) {
 
 // ObjectLost
 // - the remote device is no longer available
-// - RemoveResource from aggregator using path
+// - RemoveResource from aggregator using the unique name (UID)
 void ClientListener::ObjectLost (ajn::ProxyBusObject& proxy) {
     std::string name = proxy.GetUniqueName();
     std::string path = proxy.GetPath();
+    lost_->Add ();
 
     std::cout << "\n[LISTENER] : " << name << " connection lost\n";
     std::cout << "\tPath : " << path << " no longer exists\n";
@@ -89,6 +98,7 @@ void ClientListener::PropertiesChanged (ajn::ProxyBusObject& obj,
                                         const ajn::MsgArg& changed,
                                         const ajn::MsgArg& invalidated,
                                         void* context) {
+    changed_->Add ();
     std::map <std::string, unsigned int> init;
     init = ClientListener::MapProperties (changed);
     vpp_ptr_->UpdateResource (init, obj.GetUniqueName ());
@@ -3,11 +3,15 @@
 #include <sstream>
 #include <vector>
 #include "include/CommandLineInterface.h"
+#include "include/Metrics.h"
 
 // Constructor
-// - pass pointer to aggregator object for control
-CommandLineInterface::CommandLineInterface (Aggregator* vpp, Operator* opr) 
-    : vpp_ptr_(vpp), oper_ptr_(opr) {
+// - pass pointer to aggregator object for control, the scheduler is used to
+// - display the task deadline accounting
+CommandLineInterface::CommandLineInterface (Aggregator* vpp,
+                                            Operator* opr,
+                                            Scheduler* scheduler)
+    : vpp_ptr_(vpp), oper_ptr_(opr), scheduler_ptr_(scheduler) {
 }  // end constructor
 
 CommandLineInterface::~CommandLineInterface () {
@@ -23,6 +27,7 @@ void CommandLineInterface::Help () {
         << "> a                 display all resources\n"
         << "> f                 display filtered resources\n"
         << "> s                 display summary\n"
+        << "> m                 display metrics\n"
         << "> t <arg arg...>    targets filter\n"
         << "> i <watts>         import power\n"
         << "> e <watts>         export power\n"
@@ -70,8 +75,21 @@ bool CommandLineInterface::Control (const std::string& input) {
             break;
         }
         case 's': {
-            oper_ptr_->Summary ();
-            vpp_ptr_->DisplaySummary ();
+            // chain the summaries so they print in order on the scheduler
+            // thread, the scheduler summary is read after the other two
+            Aggregator* vpp = vpp_ptr_;
+            Scheduler* scheduler = scheduler_ptr_;
+            oper_ptr_->Summary ([vpp, scheduler] {
+                vpp->DisplaySummary ([scheduler] {
+                    if (scheduler) {
+                        scheduler->DisplaySummary ();
+                    }
+                });
+            });
+            break;
+        }
+        case 'm': {
+            Metrics::Instance ().DisplaySummary ();
             break;
         }
         case 't': {
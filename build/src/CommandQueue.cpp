@@ -0,0 +1,227 @@
+#include <iostream>
+#include "include/CommandQueue.h"
+
+// constructor
+// - start the worker pool. The timeout is in milliseconds, a zero timeout
+// - would expire every command as it is sent so it is clamped to 1 ms.
+CommandQueue::CommandQueue (CommandTransport* transport,
+                            unsigned int workers,
+                            unsigned int timeout)
+    : transport_(transport),
+      timeout_(timeout > 0 ? timeout : 1),
+      stats_(),
+      latency_(&Metrics::Instance ().GetHistogram (
+          "deras_command_latency_seconds",
+          "Command time from send to completion.")),
+      timeouts_(&Metrics::Instance ().GetCounter (
+          "deras_command_timeouts_total",
+          "Commands dropped after the timeout.")),
+      done_(false) {
+    if (workers == 0) {
+        workers = 1;
+    }
+    for (unsigned int i = 0; i < workers; i++) {
+        workers_.emplace_back (&CommandQueue::Work, this);
+    }
+}  // end constructor
+
+CommandQueue::~CommandQueue () {
+    CommandQueue::Stop ();
+}  // end destructor
+
+// Push
+// - queue the command for its resource. If the resource already has a
+// - command waiting then it is replaced by the newer one.
+void CommandQueue::Push (const Command& command) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    stats_.pushed++;
+    Slot& slot = slots_[command.resource];
+    slot.pending = command;
+    if (slot.queued) {
+        stats_.coalesced++;
+        return;
+    }
+
+    slot.queued = true;
+    stats_.pending++;
+    if (stats_.pending > stats_.max_pending) {
+        stats_.max_pending = stats_.pending;
+    }
+    if (!slot.in_flight) {
+        ready_.push_back (command.resource);
+        ready_cv_.notify_one ();
+    }
+}  // end Push
+
+// Cancel
+// - forget the resource when it is removed. A command in flight will be
+// - counted as late when it completes.
+void CommandQueue::Cancel (unsigned long resource) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto found = slots_.find (resource);
+    if (found == slots_.end ()) {
+        return;
+    }
+    if (found->second.queued) {
+        stats_.pending--;
+    }
+    if (found->second.in_flight) {
+        stats_.in_flight--;
+    }
+    slots_.erase (found);
+}  // end Cancel
+
+// Stop
+// - signal the workers to finish and wait for them. Commands that have not
+// - been sent are dropped.
+void CommandQueue::Stop () {
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        done_ = true;
+    }
+    ready_cv_.notify_all ();
+    for (auto &worker : workers_) {
+        if (worker.joinable ()) {
+            worker.join ();
+        }
+    }
+}  // end Stop
+
+// Get Stats
+// - copy of the pipeline counters
+CommandStats CommandQueue::GetStats () {
+    std::lock_guard <std::mutex> lock (mutex_);
+    return stats_;
+}  // end Get Stats
+
+// Display Summary
+// - print the pipeline counters
+void CommandQueue::DisplaySummary () {
+    CommandStats stats = CommandQueue::GetStats ();
+    std::cout << "\nCommand Pipeline:"
+        << "\n\tPushed = " << stats.pushed
+        << "\n\tCoalesced = " << stats.coalesced
+        << "\n\tSent = " << stats.sent
+        << "\n\tCompleted = " << stats.completed
+        << "\n\tFailed = " << stats.failed
+        << "\n\tTimed Out = " << stats.timed_out
+        << "\n\tLate = " << stats.late
+        << "\n\tPending = " << stats.pending
+        << " (max " << stats.max_pending << ")"
+        << "\n\tIn Flight = " << stats.in_flight << std::endl;
+}  // end Display Summary
+
+// Work
+// - worker thread that takes the next ready resource and sends its command.
+// - the workers also expire commands that are in flight for too long, they
+// - sleep until the earliest deadline or until there is work.
+void CommandQueue::Work () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    auto ready = [this] {
+        return done_ || !ready_.empty ();
+    };
+    while (!done_) {
+        if (deadlines_.empty ()) {
+            ready_cv_.wait (lock, ready);
+        } else {
+            // copied, another worker may expire the entry while this waits
+            Clock::time_point deadline = deadlines_.begin ()->first;
+            ready_cv_.wait_until (lock, deadline, ready);
+        }
+        CommandQueue::Expire (Clock::now ());
+        if (done_ || ready_.empty ()) {
+            continue;
+        }
+
+        unsigned long resource = ready_.front ();
+        ready_.pop_front ();
+        auto found = slots_.find (resource);
+        if (found == slots_.end ()) {
+            continue;  // cancelled
+        }
+        Slot& slot = found->second;
+        if (!slot.queued || slot.in_flight) {
+            continue;
+        }
+
+        Command command = slot.pending;
+        unsigned long sequence = ++slot.sequence;
+        slot.queued = false;
+        slot.in_flight = true;
+        stats_.pending--;
+        stats_.in_flight++;
+        stats_.sent++;
+        slot.sent = Clock::now ();
+        auto deadline = deadlines_.emplace (
+            slot.sent + timeout_, std::make_pair (resource, sequence));
+        if (deadline == deadlines_.begin ()) {
+            // the other workers may be waiting without a deadline
+            ready_cv_.notify_all ();
+        }
+
+        // the transport is called without the lock so completions that
+        // happen right away can take it
+        lock.unlock ();
+        transport_->Send (command, [this, resource, sequence] (bool ok) {
+            CommandQueue::Complete (resource, sequence, ok);
+        });
+        lock.lock ();
+    }
+}  // end Work
+
+// Complete
+// - called by the transport when a command was delivered or failed. If a
+// - newer command is waiting for the resource it is made ready.
+void CommandQueue::Complete (unsigned long resource,
+                             unsigned long sequence,
+                             bool ok) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto found = slots_.find (resource);
+    if (found == slots_.end ()
+        || !found->second.in_flight
+        || found->second.sequence != sequence) {
+        stats_.late++;
+        return;
+    }
+
+    Slot& slot = found->second;
+    slot.in_flight = false;
+    stats_.in_flight--;
+    latency_->Record (std::chrono::duration_cast <std::chrono::nanoseconds>
+                      (Clock::now () - slot.sent).count ());
+    if (ok) {
+        stats_.completed++;
+    } else {
+        stats_.failed++;
+    }
+    if (slot.queued) {
+        ready_.push_back (resource);
+        ready_cv_.notify_one ();
+    }
+}  // end Complete
+
+// Expire
+// - release resources whose command has been in flight past the timeout.
+// - must be called with the lock held.
+void CommandQueue::Expire (Clock::time_point now) {
+    while (!deadlines_.empty () && deadlines_.begin ()->first <= now) {
+        unsigned long resource = deadlines_.begin ()->second.first;
+        unsigned long sequence = deadlines_.begin ()->second.second;
+        deadlines_.erase (deadlines_.begin ());
+
+        auto found = slots_.find (resource);
+        if (found == slots_.end ()
+            || !found->second.in_flight
+            || found->second.sequence != sequence) {
+            continue;  // already completed
+        }
+        Slot& slot = found->second;
+        slot.in_flight = false;
+        stats_.in_flight--;
+        stats_.timed_out++;
+        timeouts_->Add ();
+        if (slot.queued) {
+            ready_.push_back (resource);
+        }
+    }
+}  // end Expire
@@ -0,0 +1,47 @@
+#include "include/ControlChannel.h"
+
+// constructor
+// - the list starts with an empty node that the owner has consumed
+ControlChannel::ControlChannel () {
+    Node* stub = new Node;
+    stub->next.store (nullptr, std::memory_order_relaxed);
+    head_.store (stub, std::memory_order_relaxed);
+    tail_ = stub;
+}  // end constructor
+
+// destructor
+// - actions that were not drained are dropped
+ControlChannel::~ControlChannel () {
+    while (tail_) {
+        Node* next = tail_->next.load (std::memory_order_relaxed);
+        delete tail_;
+        tail_ = next;
+    }
+}  // end destructor
+
+// Post
+// - append the action, safe to call from any thread
+void ControlChannel::Post (Action action) {
+    Node* node = new Node;
+    node->next.store (nullptr, std::memory_order_relaxed);
+    node->action = std::move (action);
+    Node* previous = head_.exchange (node, std::memory_order_acq_rel);
+    previous->next.store (node, std::memory_order_release);
+}  // end Post
+
+// Drain
+// - run the posted actions on the owner thread. An action posted while
+// - draining may be left for the next drain. Returns the actions run.
+unsigned int ControlChannel::Drain () {
+    unsigned int count = 0;
+    Node* next = tail_->next.load (std::memory_order_acquire);
+    while (next) {
+        Action action = std::move (next->action);
+        delete tail_;
+        tail_ = next;
+        action ();
+        count++;
+        next = tail_->next.load (std::memory_order_acquire);
+    }
+    return count;
+}  // end Drain
@@ -0,0 +1,609 @@
+#include <algorithm>
+#include <cfloat>
+#include "include/DispatchIndex.h"
+
+// constructor
+DispatchIndex::DispatchIndex (FleetState* fleet, unsigned int bucket)
+    : fleet_(fleet),
+      bucket_(bucket > 0 ? bucket : 1),
+      size_(0),
+      cut_(),
+      selected_(),
+      wheel_(kWheel),
+      elapsed_(0),
+      slot_(0),
+      bound_(0),
+      floor_(0),
+      longest_(0),
+      shortest_(0) {
+    // do nothing
+}  // end constructor
+
+DispatchIndex::~DispatchIndex () {
+    // do nothing
+}  // end destructor
+
+// Insert
+// - add a resource to both dispatch orders. A resource placed before a cut
+// - is selected and one that was discovered while running is checked so it
+// - can be stopped by the next dispatch.
+void DispatchIndex::Insert (DistributedEnergyResource* der) {
+    unsigned int id = der->GetID ();
+    if (id >= slots_.size ()) {
+        slots_.resize (id + 1);
+    }
+    if (slots_[id]) {
+        return;
+    }
+    slots_[id].reset (new Entry);
+    size_++;
+    Entry* entry = slots_[id].get ();
+    entry->der = der;
+    for (auto direction : {EXPORT, IMPORT}) {
+        Node& node = entry->node[direction];
+        node.power = DispatchIndex::GetPower (entry, direction);
+        node.selected = false;
+        node.touched = false;
+        node.wake = 0;
+        DispatchIndex::Link (entry,
+                             direction,
+                             DispatchIndex::GetRamp (entry, direction),
+                             DispatchIndex::GetBucket (entry, direction));
+        if (DispatchIndex::Selects (entry, direction)) {
+            DispatchIndex::Select (entry, direction);
+        }
+    }
+    if (der->GetExportWatts () != 0) {
+        DispatchIndex::Touch (entry, EXPORT);
+    }
+    if (der->GetImportWatts () != 0) {
+        DispatchIndex::Touch (entry, IMPORT);
+    }
+    DispatchIndex::Schedule (entry, EXPORT);
+    DispatchIndex::Schedule (entry, IMPORT);
+}  // end Insert
+
+// Erase
+// - remove a resource from the dispatch orders. The cut steps back if it was
+// - the cut and the resource is left running as it is.
+void DispatchIndex::Erase (DistributedEnergyResource* der) {
+    Entry* entry = DispatchIndex::Find (der);
+    if (entry == nullptr) {
+        return;
+    }
+    for (auto direction : {EXPORT, IMPORT}) {
+        Node& node = entry->node[direction];
+        if (cut_[direction] == entry) {
+            cut_[direction] = DispatchIndex::Prev (entry, direction);
+        }
+        if (node.selected) {
+            selected_[direction] -= node.power;
+        }
+        DispatchIndex::Unlink (entry, direction);
+    }
+    slots_[der->GetID ()].reset ();
+    size_--;
+}  // end Erase
+
+// Update
+// - reload the ramp and rated power of a resource and re-key it right away,
+// - used after its properties were updated
+void DispatchIndex::Update (DistributedEnergyResource* der) {
+    Entry* entry = DispatchIndex::Find (der);
+    if (entry == nullptr) {
+        return;
+    }
+    for (auto direction : {EXPORT, IMPORT}) {
+        DispatchIndex::Reload (entry, direction);
+        DispatchIndex::Touch (entry, direction);
+        DispatchIndex::Schedule (entry, direction);
+    }
+}  // end Update
+
+// Refresh
+// - advance the clock by the tick after the digital twins were updated and
+// - re-key the resources whose timer is due. The timers allow ticks from the
+// - floor to the bound in milliseconds, a longer tick moves more energy in
+// - a ramp and shorter ticks round the twin energy more often. A tick out of
+// - range, or one that skips the wheel, re-keys every resource and widens
+// - the range. The range is narrowed to the recent ticks once per turn of
+// - the wheel.
+void DispatchIndex::Refresh (float delta_time) {
+    if (delta_time <= 0) {
+        return;  // the twins did not move
+    }
+    elapsed_ += delta_time;
+    longest_ = std::max (longest_, delta_time);
+    shortest_ = shortest_ > 0 ? std::min (shortest_, delta_time) : delta_time;
+    unsigned long slot = elapsed_ / kResolution;
+    if (delta_time > bound_ || delta_time < floor_
+        || slot - slot_ >= kWheel) {
+        bound_ = std::max (bound_, delta_time * kMargin);
+        floor_ = floor_ > 0 ? std::min (floor_, delta_time / kMargin)
+                            : delta_time / kMargin;
+        slot_ = slot;
+        for (auto &timers : wheel_) {
+            timers.clear ();
+        }
+        next_.clear ();
+        for (auto &entry : slots_) {
+            if (!entry) {
+                continue;
+            }
+            for (auto direction : {EXPORT, IMPORT}) {
+                DispatchIndex::Rekey (entry.get (), direction);
+                DispatchIndex::Schedule (entry.get (), direction);
+            }
+        }
+        return;
+    }
+    if (slot / kWheel != slot_ / kWheel) {
+        bound_ = longest_ * kMargin;
+        floor_ = shortest_ / kMargin;
+        longest_ = 0;
+        shortest_ = 0;
+    }
+
+    due_.clear ();
+    due_.swap (next_);
+    while (true) {
+        for (const auto &timer : due_) {
+            Entry* entry = DispatchIndex::Find (timer.id);
+            if (entry == nullptr
+                || entry->node[timer.direction].wake != timer.wake) {
+                continue;  // erased or set again since
+            }
+            DispatchIndex::Rekey (entry, timer.direction);
+            DispatchIndex::Schedule (entry, timer.direction);
+        }
+        if (slot_ == slot) {
+            break;
+        }
+        slot_++;
+        due_.clear ();
+        due_.swap (wheel_[slot_ % kWheel]);
+    }
+}  // end Refresh
+
+// Clear
+// - remove all resources from the index
+void DispatchIndex::Clear () {
+    for (auto direction : {EXPORT, IMPORT}) {
+        orders_[direction].clear ();
+        touched_[direction].clear ();
+        cut_[direction] = nullptr;
+        selected_[direction] = 0;
+    }
+    for (auto &slot : wheel_) {
+        slot.clear ();
+    }
+    next_.clear ();
+    slots_.clear ();
+    size_ = 0;
+}  // end Clear
+
+// Size
+// - number of indexed resources
+unsigned int DispatchIndex::Size () {
+    return size_;
+}  // end Size
+
+// Export Power
+// - send the export signal to the greatest ramp and then export energy
+// - resources until the dispatch watts have been met, reference Dispatch
+void DispatchIndex::ExportPower (unsigned int watts) {
+    DispatchIndex::Dispatch (EXPORT, watts);
+}  // end Export Power
+
+// Import Power
+// - send the import signal to the greatest ramp and then import energy
+// - resources until the dispatch watts have been met, reference Dispatch
+void DispatchIndex::ImportPower (unsigned int watts) {
+    DispatchIndex::Dispatch (IMPORT, watts);
+}  // end Import Power
+
+// Find
+// - get the entry stored in the resource's fleet id slot
+DispatchIndex::Entry* DispatchIndex::Find (DistributedEnergyResource* der) {
+    Entry* entry = DispatchIndex::Find (der->GetID ());
+    if (entry == nullptr || entry->der != der) {
+        return nullptr;
+    }
+    return entry;
+}  // end Find
+
+DispatchIndex::Entry* DispatchIndex::Find (unsigned int id) {
+    if (id >= slots_.size ()) {
+        return nullptr;
+    }
+    return slots_[id].get ();
+}  // end Find
+
+// Get Ramp
+unsigned int DispatchIndex::GetRamp (Entry* entry, Direction direction) {
+    if (direction == EXPORT) {
+        return entry->der->GetExportRamp ();
+    }
+    return entry->der->GetImportRamp ();
+}  // end Get Ramp
+
+// Get Power
+// - the rated power, it is cached in the node since it only changes with an
+// - update
+unsigned int DispatchIndex::GetPower (Entry* entry, Direction direction) {
+    if (direction == EXPORT) {
+        return entry->der->GetRatedExportPower ();
+    }
+    return entry->der->GetRatedImportPower ();
+}  // end Get Power
+
+// Get Energy
+// - the twin energy available in the direction, it is read from the fleet
+// - state so the timers see the fraction of a Wh
+float DispatchIndex::GetEnergy (Entry* entry, Direction direction) {
+    unsigned int id = entry->der->GetID ();
+    if (direction == EXPORT) {
+        return fleet_->export_energy[id];
+    }
+    return fleet_->import_energy[id];
+}  // end Get Energy
+
+// Get Bucket
+// - resources in one bucket are dispatched in the order they entered it
+unsigned int DispatchIndex::GetBucket (Entry* entry, Direction direction) {
+    unsigned int energy = DispatchIndex::GetEnergy (entry, direction);
+    return energy / bucket_;
+}  // end Get Bucket
+
+// Get Rated Energy
+unsigned int DispatchIndex::GetRatedEnergy (Entry* entry,
+                                            Direction direction) {
+    if (direction == EXPORT) {
+        return entry->der->GetRatedExportEnergy ();
+    }
+    return entry->der->GetRatedImportEnergy ();
+}  // end Get Rated Energy
+
+// Link
+// - append the entry to the tail of its (ramp, bucket) list. A level is
+// - kept when it empties since a fleet only has a few ramp rates.
+void DispatchIndex::Link (Entry* entry,
+                          Direction direction,
+                          unsigned int ramp,
+                          unsigned int bucket) {
+    Order& order = orders_[direction];
+    Order::iterator level = order.find (ramp);
+    if (level == order.end ()) {
+        level = order.emplace (ramp, Level ()).first;
+        level->second.count = 0;
+    }
+    std::vector <Bucket>& buckets = level->second.buckets;
+    if (bucket >= buckets.size ()) {
+        buckets.resize (bucket + 1, Bucket {nullptr, nullptr});
+    }
+
+    Bucket& list = buckets[bucket];
+    Node& node = entry->node[direction];
+    node.prev = list.tail;
+    node.next = nullptr;
+    node.level = level;
+    node.ramp = ramp;
+    node.bucket = bucket;
+    if (list.tail != nullptr) {
+        list.tail->node[direction].next = entry;
+    } else {
+        list.head = entry;
+    }
+    list.tail = entry;
+    level->second.count++;
+}  // end Link
+
+// Unlink
+// - remove the entry from its (ramp, bucket) list
+void DispatchIndex::Unlink (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    Bucket& list = node.level->second.buckets[node.bucket];
+    if (node.prev != nullptr) {
+        node.prev->node[direction].next = node.next;
+    } else {
+        list.head = node.next;
+    }
+    if (node.next != nullptr) {
+        node.next->node[direction].prev = node.prev;
+    } else {
+        list.tail = node.prev;
+    }
+    node.level->second.count--;
+}  // end Unlink
+
+// Relink
+// - move the entry to a new key. The cut steps back if the entry was the
+// - cut and the entry is selected if it lands before the cut.
+void DispatchIndex::Relink (Entry* entry,
+                            Direction direction,
+                            unsigned int ramp,
+                            unsigned int bucket) {
+    if (cut_[direction] == entry) {
+        cut_[direction] = DispatchIndex::Prev (entry, direction);
+    }
+    DispatchIndex::Unlink (entry, direction);
+    DispatchIndex::Link (entry, direction, ramp, bucket);
+    bool selected = DispatchIndex::Selects (entry, direction);
+    if (selected && !entry->node[direction].selected) {
+        DispatchIndex::Select (entry, direction);
+    } else if (!selected && entry->node[direction].selected) {
+        DispatchIndex::Deselect (entry, direction);
+    }
+}  // end Relink
+
+// Rekey
+// - move the entry if its energy bucket changed, returns true if it moved
+bool DispatchIndex::Rekey (Entry* entry, Direction direction) {
+    const Node& node = entry->node[direction];
+    unsigned int bucket = DispatchIndex::GetBucket (entry, direction);
+    if (node.bucket == bucket) {
+        return false;
+    }
+    DispatchIndex::Relink (entry, direction, node.ramp, bucket);
+    return true;
+}  // end Rekey
+
+// Reload
+// - re-read the ramp and rated power and move the entry if its ramp or
+// - energy bucket changed
+void DispatchIndex::Reload (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    unsigned int power = DispatchIndex::GetPower (entry, direction);
+    if (node.selected) {
+        selected_[direction] += power;
+        selected_[direction] -= node.power;
+    }
+    node.power = power;
+
+    unsigned int ramp = DispatchIndex::GetRamp (entry, direction);
+    if (node.ramp == ramp) {
+        DispatchIndex::Rekey (entry, direction);
+        return;
+    }
+    DispatchIndex::Relink (entry,
+                           direction,
+                           ramp,
+                           DispatchIndex::GetBucket (entry, direction));
+}  // end Reload
+
+// Schedule
+// - set the timer for the first time the entry could leave its bucket. The
+// - rate is the most energy per millisecond the twin moves, reference
+// - FleetState::Loop, with the ramp of a tick as long as the bound and half
+// - a float step of rounding in each tick as short as the floor. Energy
+// - clamped inside the bucket needs no timer.
+void DispatchIndex::Schedule (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    node.wake = 0;
+
+    const FleetState& fleet = *fleet_;
+    const unsigned int id = entry->der->GetID ();
+    const float seconds = bound_ / 1000;
+    float watts;
+    bool rising;
+    if (fleet.import_watts[id] > 0) {
+        watts = std::max ({float (fleet.import_watts[id]),
+                           fleet.import_power[id],
+                           float (fleet.rated_import_power[id])});
+        watts += fleet.import_ramp[id] * seconds / 2;
+        rising = direction == EXPORT;
+    } else if (fleet.export_watts[id] > 0) {
+        watts = std::max ({float (fleet.export_watts[id]),
+                           fleet.export_power[id],
+                           float (fleet.rated_export_power[id])});
+        watts += fleet.export_ramp[id] * seconds / 2;
+        rising = direction == IMPORT;
+    } else {
+        watts = fleet.idle_losses[id];
+        rising = direction == IMPORT;
+    }
+    if (watts <= 0) {
+        return;
+    }
+    float rated = DispatchIndex::GetRatedEnergy (entry, direction);
+    if (floor_ > 0) {
+        watts += rated * FLT_EPSILON / 2 * (60*60*1000) / floor_;
+    }
+
+    float energy = DispatchIndex::GetEnergy (entry, direction);
+    float distance;
+    if (rising) {
+        unsigned int edge = (node.bucket + 1) * bucket_;
+        if (edge > rated) {
+            return;
+        }
+        distance = edge - energy;
+    } else {
+        if (node.bucket == 0) {
+            return;
+        }
+        distance = energy - node.bucket * bucket_;
+    }
+
+    // a timer in a slot that was already run waits for the next refresh
+    // and one past the wheel wakes at its end to be set again
+    double wake = elapsed_ + distance / watts * (60*60*1000);
+    unsigned long slot = wake / kResolution;
+    slot = std::min (slot, slot_ + kWheel - 1);
+    node.wake = slot;
+    if (slot <= slot_) {
+        next_.push_back (Timer {id, direction, slot});
+    } else {
+        wheel_[slot % kWheel].push_back (Timer {id, direction, slot});
+    }
+}  // end Schedule
+
+// Next
+// - the entry after this one in the order, the first entry for nullptr
+DispatchIndex::Entry* DispatchIndex::Next (Entry* entry,
+                                           Direction direction) {
+    Order& order = orders_[direction];
+    Order::iterator level;
+    unsigned int i;
+    if (entry == nullptr) {
+        level = order.begin ();
+        if (level == order.end ()) {
+            return nullptr;
+        }
+        i = level->second.buckets.size ();
+    } else {
+        const Node& node = entry->node[direction];
+        if (node.next != nullptr) {
+            return node.next;
+        }
+        level = node.level;
+        i = node.bucket;
+    }
+
+    while (true) {
+        if (level->second.count > 0) {
+            std::vector <Bucket>& buckets = level->second.buckets;
+            while (i-- > 0) {
+                if (buckets[i].head != nullptr) {
+                    return buckets[i].head;
+                }
+            }
+        }
+        if (++level == order.end ()) {
+            return nullptr;
+        }
+        i = level->second.buckets.size ();
+    }
+}  // end Next
+
+// Prev
+// - the entry before this one in the order, nullptr for the first entry
+DispatchIndex::Entry* DispatchIndex::Prev (Entry* entry,
+                                           Direction direction) {
+    const Node& node = entry->node[direction];
+    if (node.prev != nullptr) {
+        return node.prev;
+    }
+    Order& order = orders_[direction];
+    Order::iterator level = node.level;
+    unsigned int i = node.bucket + 1;
+    while (true) {
+        if (level->second.count > 0) {
+            std::vector <Bucket>& buckets = level->second.buckets;
+            for (; i < buckets.size (); i++) {
+                if (buckets[i].tail != nullptr) {
+                    return buckets[i].tail;
+                }
+            }
+        }
+        if (level == order.begin ()) {
+            return nullptr;
+        }
+        level--;
+        i = 0;
+    }
+}  // end Prev
+
+// Selects
+// - true if an entry just linked at the tail of its list is before the cut.
+// - Within the cut's own list the entry is after it.
+bool DispatchIndex::Selects (Entry* entry, Direction direction) {
+    const Entry* cut = cut_[direction];
+    if (cut == nullptr || cut == entry) {
+        return false;
+    }
+    const Node& node = entry->node[direction];
+    const Node& edge = cut->node[direction];
+    return node.ramp > edge.ramp
+        || (node.ramp == edge.ramp && node.bucket > edge.bucket);
+}  // end Selects
+
+// Select
+void DispatchIndex::Select (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    node.selected = true;
+    selected_[direction] += node.power;
+    DispatchIndex::Touch (entry, direction);
+}  // end Select
+
+// Deselect
+void DispatchIndex::Deselect (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    node.selected = false;
+    selected_[direction] -= node.power;
+    DispatchIndex::Touch (entry, direction);
+}  // end Deselect
+
+// Touch
+// - queue the entry to have its command checked by the next dispatch
+void DispatchIndex::Touch (Entry* entry, Direction direction) {
+    Node& node = entry->node[direction];
+    if (!node.touched) {
+        node.touched = true;
+        touched_[direction].push_back (entry->der->GetID ());
+    }
+}  // end Touch
+
+// Dispatch
+// - move the cut forward until the selected rated watts meet the dispatch
+// - watts, then back while the entries before the cut still meet them. Only
+// - the entries whose selection changed, or that were re-keyed or updated,
+// - are checked: a selected resource that is not running is sent the
+// - signal and one that is no longer selected is told to stop.
+void DispatchIndex::Dispatch (Direction direction, unsigned int watts) {
+    Entry*& cut = cut_[direction];
+    unsigned long& selected = selected_[direction];
+    while (selected < watts) {
+        Entry* next = DispatchIndex::Next (cut, direction);
+        if (next == nullptr) {
+            break;
+        }
+        DispatchIndex::Select (next, direction);
+        cut = next;
+    }
+    while (cut != nullptr && selected - cut->node[direction].power >= watts) {
+        Entry* prev = DispatchIndex::Prev (cut, direction);
+        DispatchIndex::Deselect (cut, direction);
+        cut = prev;
+    }
+
+    for (auto id : touched_[direction]) {
+        Entry* entry = DispatchIndex::Find (id);
+        if (entry == nullptr || !entry->node[direction].touched) {
+            continue;  // erased or already checked
+        }
+        Node& node = entry->node[direction];
+        node.touched = false;
+        DistributedEnergyResource* der = entry->der;
+        bool command = false;
+        if (direction == EXPORT) {
+            if (node.selected && der->GetExportPower () == 0
+                && der->GetExportWatts () == 0) {
+                // AllJoyn Method Call and digital twin
+                der->RemoteExportPower (node.power);
+                command = true;
+            } else if (!node.selected && der->GetExportWatts () != 0) {
+                // AllJoyn Method Call
+                der->RemoteExportPower (0);
+                command = true;
+            }
+        } else {
+            if (node.selected && der->GetImportPower () == 0
+                && der->GetImportWatts () == 0) {
+                // AllJoyn Method Call and digital twin
+                der->RemoteImportPower (node.power);
+                command = true;
+            } else if (!node.selected && der->GetImportWatts () != 0) {
+                // AllJoyn Method Call
+                der->RemoteImportPower (0);
+                command = true;
+            }
+        }
+        // the twin now moves energy at another rate in both orders
+        if (command) {
+            DispatchIndex::Schedule (entry, EXPORT);
+            DispatchIndex::Schedule (entry, IMPORT);
+        }
+    }
+    touched_[direction].clear ();
+}  // end Dispatch
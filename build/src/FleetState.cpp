@@ -0,0 +1,161 @@
+#include <algorithm>
+#include "include/FleetState.h"
+
+// Swap Remove
+// - move the last row into the removed row to keep the ids dense
+template <typename T>
+static void SwapRemove (std::vector <T> &column, unsigned int id) {
+    column[id] = column.back ();
+    column.pop_back ();
+}  // end Swap Remove
+
+// Clamp
+// - limit value between zero and the upper bound
+static inline float Clamp (float value, float upper) {
+    return std::min (std::max (value, 0.0f), upper);
+}  // end Clamp
+
+// constructor
+FleetState::FleetState () {
+    // do nothing
+}  // end constructor
+
+FleetState::~FleetState () {
+    // do nothing
+}  // end destructor
+
+// Add
+// - append a new row from the DER properties and return its id
+unsigned int FleetState::Add (std::map <std::string, unsigned int> &init) {
+    rated_export_power.push_back (init["rated_export_power"]);
+    rated_export_energy.push_back (init["rated_export_energy"]);
+    export_ramp.push_back (init["export_ramp"]);
+    rated_import_power.push_back (init["rated_import_power"]);
+    rated_import_energy.push_back (init["rated_import_energy"]);
+    import_ramp.push_back (init["import_ramp"]);
+    idle_losses.push_back (init["idle_losses"]);
+    export_power.push_back (init["export_power"]);
+    export_energy.push_back (init["export_energy"]);
+    import_power.push_back (init["import_power"]);
+    import_energy.push_back (init["import_energy"]);
+    export_watts.push_back (init["export_power"]);
+    import_watts.push_back (init["import_power"]);
+    target.push_back (0);
+    return target.size () - 1;
+}  // end Add
+
+// Remove
+// - remove the row by moving the last row into its place. The owner of the
+// - last row must take the removed id.
+void FleetState::Remove (unsigned int id) {
+    SwapRemove (rated_export_power, id);
+    SwapRemove (rated_export_energy, id);
+    SwapRemove (export_ramp, id);
+    SwapRemove (rated_import_power, id);
+    SwapRemove (rated_import_energy, id);
+    SwapRemove (import_ramp, id);
+    SwapRemove (idle_losses, id);
+    SwapRemove (export_power, id);
+    SwapRemove (export_energy, id);
+    SwapRemove (import_power, id);
+    SwapRemove (import_energy, id);
+    SwapRemove (export_watts, id);
+    SwapRemove (import_watts, id);
+    SwapRemove (target, id);
+}  // end Remove
+
+// Reserve
+// - reserve memory for a known fleet size
+void FleetState::Reserve (unsigned int size) {
+    rated_export_power.reserve (size);
+    rated_export_energy.reserve (size);
+    export_ramp.reserve (size);
+    rated_import_power.reserve (size);
+    rated_import_energy.reserve (size);
+    import_ramp.reserve (size);
+    idle_losses.reserve (size);
+    export_power.reserve (size);
+    export_energy.reserve (size);
+    import_power.reserve (size);
+    import_energy.reserve (size);
+    export_watts.reserve (size);
+    import_watts.reserve (size);
+    target.reserve (size);
+}  // end Reserve
+
+// Size
+// - number of rows in the fleet
+unsigned int FleetState::Size () {
+    return target.size ();
+}  // end Size
+
+// Loop
+// - update the digital twin of every resource. Each row is either importing,
+// - exporting or idle. The power ramps toward the control watts and energy
+// - moves between import and export. Branches are written as selects so the
+// - compiler can vectorize the pass.
+void FleetState::Loop (float delta_time) {
+    const float seconds = delta_time / 1000;
+    const float hours = seconds / (60*60);
+    const unsigned int size = Size ();
+
+    const unsigned int* rated_ep = rated_export_power.data ();
+    const unsigned int* rated_ee = rated_export_energy.data ();
+    const unsigned int* e_ramp = export_ramp.data ();
+    const unsigned int* rated_ip = rated_import_power.data ();
+    const unsigned int* rated_ie = rated_import_energy.data ();
+    const unsigned int* i_ramp = import_ramp.data ();
+    const unsigned int* idle = idle_losses.data ();
+    const unsigned int* ew = export_watts.data ();
+    const unsigned int* iw = import_watts.data ();
+    float* ep = export_power.data ();
+    float* ee = export_energy.data ();
+    float* ip = import_power.data ();
+    float* ie = import_energy.data ();
+
+    for (unsigned int i = 0; i < size; i++) {
+        const bool importing = iw[i] > 0;
+        const bool exporting = (iw[i] == 0) & (ew[i] > 0);
+        const bool idling = (iw[i] == 0) & (ew[i] == 0);
+        const float import_watts = iw[i];
+        const float export_watts = ew[i];
+
+        // regulate import power
+        // - ramp up toward the control watts or down from them
+        const float ramp_import = i_ramp[i] * seconds;
+        float import_power = ip[i];
+        float ramp_up = Clamp (import_power + ramp_import, import_watts);
+        float ramp_down = Clamp (import_watts - ramp_import, import_watts);
+        float ramped = import_power < import_watts ? ramp_up : ramp_down;
+        ramped = import_power == import_watts ? import_power : ramped;
+        import_power = importing ? ramped : import_power;
+        import_power = idling ? 0.0f : import_power;
+
+        // regulate export power
+        const float ramp_export = e_ramp[i] * seconds;
+        float export_power = ep[i];
+        ramp_up = Clamp (export_power + ramp_export, export_watts);
+        ramp_down = Clamp (export_power - ramp_export, export_watts);
+        ramped = export_power < export_watts ? ramp_up : ramp_down;
+        ramped = export_power == export_watts ? export_power : ramped;
+        export_power = exporting ? ramped : export_power;
+        export_power = idling ? 0.0f : export_power;
+
+        // regulate energy
+        // - if the power didn't reach rated then include ramp in energy calc
+        const float rated_import = rated_ip[i];
+        const float rated_export = rated_ep[i];
+        float import_wh = import_power * hours;
+        float export_wh = export_power * hours;
+        import_wh += import_power < rated_import ? ramp_import * hours/2 : 0.0f;
+        export_wh += export_power < rated_export ? ramp_export * hours/2 : 0.0f;
+        const float loss = idle[i] * hours;
+        float delta_wh = importing ? import_wh : -loss;
+        delta_wh = exporting ? -export_wh : delta_wh;
+
+        ip[i] = import_power;
+        ep[i] = export_power;
+        ie[i] = Clamp (ie[i] - delta_wh, rated_ie[i]);
+        ee[i] = Clamp (ee[i] + delta_wh, rated_ee[i]);
+    }
+}  // end Loop
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include "include/FrequencyDetector.h"
+
+// constructor
+// - the moving average starts full of the nominal frequency
+FrequencyDetector::FrequencyDetector (const FrequencyThresholds& thresholds,
+                                      float nominal)
+    : thresholds_(thresholds),
+      nominal_(nominal),
+      window_(thresholds.window > 0 ? thresholds.window : 1) {
+    FrequencyDetector::Reset ();
+}  // end constructor
+
+FrequencyDetector::~FrequencyDetector () {
+    // do nothing
+}  // end destructor
+
+// Set Handler
+// - the handler is called on the thread that pushes the samples
+void FrequencyDetector::SetHandler (EventHandler handler) {
+    handler_ = handler;
+}  // end Set Handler
+
+// Reset
+// - forget the samples and any deviation or event without reporting them
+void FrequencyDetector::Reset () {
+    std::fill (window_.begin (), window_.end (), nominal_);
+    head_ = 0;
+    sum_ = static_cast <double> (nominal_) * window_.size ();
+    previous_hz_ = nominal_;
+    for (unsigned int i = 0; i < 2; i++) {
+        deviations_[i] = Deviation ();
+        events_[i] = Event ();
+    }
+}  // end Reset
+
+// Push
+// - process the next sample. The running sum is kept in double so it stays
+// - exact for frequency samples and does not drift over a long stream.
+void FrequencyDetector::Push (double time, float hz) {
+    float previous_hz = previous_hz_;
+    previous_hz_ = hz;
+    sum_ += hz;
+    sum_ -= window_[head_];
+    window_[head_] = hz;
+    if (++head_ == window_.size ()) {
+        head_ = 0;
+    }
+    float average = sum_ / window_.size ();
+
+    FrequencyDetector::Track (FrequencyEvent::UNDER,
+                              time, hz, previous_hz, average);
+    FrequencyDetector::Track (FrequencyEvent::OVER,
+                              time, hz, previous_hz, average);
+    FrequencyDetector::Recover (FrequencyEvent::UNDER, time, hz, average);
+    FrequencyDetector::Recover (FrequencyEvent::OVER, time, hz, average);
+    FrequencyDetector::Detect (FrequencyEvent::UNDER, time, hz);
+    FrequencyDetector::Detect (FrequencyEvent::OVER, time, hz);
+
+    // under frequency takes priority since the response stops importing
+    if (events_[FrequencyEvent::UNDER].active
+        && events_[FrequencyEvent::OVER].active) {
+        FrequencyDetector::Cancel (FrequencyEvent::OVER);
+    }
+}  // end Push
+
+// Push
+// - batch mode for backtesting, the samples must be in time order
+void FrequencyDetector::Push (const double* times,
+                              const float* hz,
+                              unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+        FrequencyDetector::Push (times[i], hz[i]);
+    }
+}  // end Push
+
+// Is Active
+// - true while an event in the direction is in its hold time, the lockout
+// - does not end when the event recovers
+bool FrequencyDetector::IsActive (FrequencyEvent::Direction direction) const {
+    return events_[direction].active;
+}  // end Is Active
+
+// Get Elapsed
+// - seconds from the start of the active event to the time
+double FrequencyDetector::GetElapsed (FrequencyEvent::Direction direction,
+                                      double time) const {
+    if (!events_[direction].active) {
+        return 0;
+    }
+    return time - events_[direction].time;
+}  // end Get Elapsed
+
+// Get Moving Average
+float FrequencyDetector::GetMovingAverage () const {
+    return sum_ / window_.size ();
+}  // end Get Moving Average
+
+// Get Thresholds
+const FrequencyThresholds& FrequencyDetector::GetThresholds () const {
+    return thresholds_;
+}  // end Get Thresholds
+
+// Read Thresholds
+// - the fer_ keys of the operator section, reference config.ini
+FrequencyThresholds FrequencyDetector::ReadThresholds (
+    std::map <std::string, std::string>& init) {
+    FrequencyThresholds thresholds;
+    thresholds.window = stoul(init["fer_window"]);
+    thresholds.floor = stof(init["fer_floor"]);
+    thresholds.ceiling = stof(init["fer_ceiling"]);
+    thresholds.slew = stof(init["fer_slew"]);
+    thresholds.delta = stof(init["fer_delta"]);
+    thresholds.rebound = stof(init["fer_rebound"]);
+    thresholds.hold = stof(init["fer_hold"]);
+    return thresholds;
+}  // end Read Thresholds
+
+// Track
+// - follow the deviation in one direction. The sign turns the over frequency
+// - case into the under frequency case so "below" means away from nominal.
+// - a deviation that starts again on the sample after it ended continues
+// - from the same start, so noise right after a step does not hide it.
+void FrequencyDetector::Track (FrequencyEvent::Direction direction,
+                               double time,
+                               float hz,
+                               float previous_hz,
+                               float average) {
+    Deviation& deviation = deviations_[direction];
+    float sign = direction == FrequencyEvent::UNDER ? 1 : -1;
+    bool outside = direction == FrequencyEvent::UNDER
+        ? hz < thresholds_.floor
+        : hz > thresholds_.ceiling;
+    bool beyond_average = sign * (average - hz) > 0;
+
+    if (!deviation.active) {
+        bool resume = deviation.resume;
+        deviation.resume = false;
+        if (!outside || !beyond_average || sign * (previous_hz - hz) <= 0) {
+            return;
+        }
+        deviation.active = true;
+        if (!resume) {
+            deviation.start_time = time;
+            deviation.start_hz = previous_hz;
+            deviation.extreme_time = time;
+            deviation.extreme_hz = hz;
+            deviation.delta_hz = 0;
+            deviation.duration = 0;
+            return;
+        }
+    }
+
+    if (sign * (deviation.extreme_hz - hz) > 0) {
+        deviation.extreme_time = time;
+        deviation.extreme_hz = hz;
+    } else if (sign * (hz - deviation.extreme_hz) > thresholds_.rebound) {
+        // the frequency is recovering so the extreme is the nadir
+        Event& event = events_[direction];
+        if (event.open && !event.nadir) {
+            event.record.extreme_time = deviation.extreme_time;
+            event.record.extreme_hz = deviation.extreme_hz;
+            event.nadir = true;
+            FrequencyDetector::Emit (FrequencyEvent::NADIR, event, time, hz);
+        }
+        deviation.active = false;
+        deviation.resume = true;
+        deviation.delta_hz = 0;
+        deviation.duration = 0;
+        return;
+    }
+
+    if (beyond_average) {
+        deviation.delta_hz = sign * (deviation.start_hz - hz);
+        deviation.duration = time - deviation.start_time;
+    }
+    Event& event = events_[direction];
+    if (event.open && !event.nadir) {
+        event.record.extreme_time = deviation.extreme_time;
+        event.record.extreme_hz = deviation.extreme_hz;
+    }
+}  // end Track
+
+// Detect
+// - end the lockout after the hold time and start an event when the
+// - deviation is large and fast enough. The slew is measured over at least
+// - one second. An event that has not recovered when the next one starts is
+// - replaced without a recovery.
+void FrequencyDetector::Detect (FrequencyEvent::Direction direction,
+                                double time,
+                                float hz) {
+    Event& event = events_[direction];
+    if (event.active) {
+        if (time - event.time <= thresholds_.hold) {
+            return;
+        }
+        event.active = false;
+    }
+
+    const Deviation& deviation = deviations_[direction];
+    if (deviation.active
+        && deviation.duration >= 1
+        && deviation.delta_hz >= thresholds_.slew * deviation.duration
+        && deviation.delta_hz >= thresholds_.delta) {
+        event.active = true;
+        event.open = true;
+        event.nadir = false;
+        event.time = time;
+        event.record.direction = direction;
+        event.record.start_time = deviation.start_time;
+        event.record.start_hz = deviation.start_hz;
+        event.record.extreme_time = deviation.extreme_time;
+        event.record.extreme_hz = deviation.extreme_hz;
+        FrequencyDetector::Emit (FrequencyEvent::START, event, time, hz);
+    }
+}  // end Detect
+
+// Recover
+// - report the recovery once the averaged frequency is back in the floor or
+// - ceiling band. The moving average lags, so a short deviation may never
+// - move it out of the band, and the event also waits for its nadir and for
+// - the frequency itself to be back in the band. The lockout keeps its own
+// - hold time, reference Detect.
+void FrequencyDetector::Recover (FrequencyEvent::Direction direction,
+                                 double time,
+                                 float hz,
+                                 float average) {
+    Event& event = events_[direction];
+    if (!event.open || !event.nadir) {
+        return;
+    }
+    bool inside = direction == FrequencyEvent::UNDER
+        ? hz >= thresholds_.floor && average >= thresholds_.floor
+        : hz <= thresholds_.ceiling && average <= thresholds_.ceiling;
+    if (inside) {
+        event.open = false;
+        FrequencyDetector::Emit (FrequencyEvent::RECOVERY, event, time, hz);
+    }
+}  // end Recover
+
+// Cancel
+// - end the lockout early, the event still reports its recovery
+void FrequencyDetector::Cancel (FrequencyEvent::Direction direction) {
+    events_[direction].active = false;
+}  // end Cancel
+
+// Emit
+// - call the handler with the event record
+void FrequencyDetector::Emit (FrequencyEvent::Type type,
+                              Event& event,
+                              double time,
+                              float hz) {
+    if (!handler_) {
+        return;
+    }
+    event.record.type = type;
+    event.record.time = time;
+    event.record.hz = hz;
+    handler_ (event.record);
+}  // end Emit
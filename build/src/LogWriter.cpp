@@ -0,0 +1,308 @@
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "include/LogWriter.h"
+
+// constructor
+// - every slot starts with its own position as the sequence so the first
+// - pass of the producers finds them free
+LogWriter::LogWriter ()
+    : ring_(new Slot[kCapacity]),
+      head_(0),
+      tail_(0),
+      count_(0),
+      written_(0),
+      pending_blocks_(0),
+      done_(false),
+      stamp_time_(-1),
+      stamp_date_(),
+      stamp_date_time_(),
+      stamp_length_(0),
+      records_(0),
+      blocks_count_(0),
+      stalls_(0),
+      truncated_(0),
+      writes_(0),
+      errors_(0),
+      backlog_(&Metrics::Instance ().GetGauge ("deras_log_backlog",
+          "Log records and blocks waiting for the writer.")) {
+    for (size_t i = 0; i < kCapacity; i++) {
+        ring_[i].sequence.store (i, std::memory_order_relaxed);
+    }
+    for (auto &sink : sinks_) {
+        sink.fd = -1;
+    }
+    thread_ = std::thread (&LogWriter::Write, this);
+}  // end constructor
+
+// destructor
+// - the writer drains everything that was pushed before it stops
+LogWriter::~LogWriter () {
+    done_.store (true);
+    wake_cv_.notify_one ();
+    thread_.join ();
+}  // end destructor
+
+// Instance
+// - the writer is created on first use and stopped at program exit
+LogWriter& LogWriter::Instance () {
+    static LogWriter writer;
+    return writer;
+}  // end Instance
+
+// Push
+// - claim the next slot, copy the record and publish it to the writer
+void LogWriter::Push (unsigned int sink,
+                      time_t time,
+                      const char* text,
+                      unsigned int length) {
+    if (sink >= kMaxSinks) {
+        return;
+    }
+    if (length > kTextSize) {
+        truncated_.fetch_add (1, std::memory_order_relaxed);
+        length = kTextSize;
+    }
+
+    size_t position = head_.load (std::memory_order_relaxed);
+    Slot* slot;
+    bool stalled = false;
+    while (true) {
+        slot = &ring_[position & (kCapacity - 1)];
+        size_t sequence = slot->sequence.load (std::memory_order_acquire);
+        intptr_t difference = intptr_t (sequence) - intptr_t (position);
+        if (difference == 0) {
+            if (head_.compare_exchange_weak (position, position + 1,
+                                             std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // the ring is full, wait for the writer
+            if (!stalled) {
+                stalled = true;
+                stalls_.fetch_add (1, std::memory_order_relaxed);
+            }
+            wake_cv_.notify_one ();
+            std::this_thread::yield ();
+            position = head_.load (std::memory_order_relaxed);
+        } else {
+            position = head_.load (std::memory_order_relaxed);
+        }
+    }
+
+    slot->time = time;
+    slot->sink = sink;
+    slot->length = length;
+    std::memcpy (slot->text, text, length);
+    slot->sequence.store (position + 1, std::memory_order_release);
+    records_.fetch_add (1, std::memory_order_relaxed);
+
+    // wake the writer early during bursts
+    if ((position & (kCapacity/4 - 1)) == 0) {
+        wake_cv_.notify_one ();
+    }
+}  // end Push
+
+// Push Block
+// - queue a binary block, the bytes are written as they are
+void LogWriter::PushBlock (unsigned int sink,
+                           time_t time,
+                           std::string&& bytes) {
+    if (sink >= kMaxSinks) {
+        return;
+    }
+    {
+        std::lock_guard <std::mutex> lock (blocks_mutex_);
+        blocks_.push_back (Block {time, sink, std::move (bytes)});
+        pending_blocks_.fetch_add (1);
+    }
+    blocks_count_.fetch_add (1, std::memory_order_relaxed);
+    wake_cv_.notify_one ();
+}  // end Push Block
+
+// Flush
+// - wait until everything pushed so far is written to the files
+void LogWriter::Flush () {
+    size_t target = head_.load ();
+    while (written_.load () < target || pending_blocks_.load () > 0) {
+        wake_cv_.notify_one ();
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    }
+}  // end Flush
+
+// Get Stats
+LogStats LogWriter::GetStats () {
+    LogStats stats;
+    stats.records = records_.load ();
+    stats.blocks = blocks_count_.load ();
+    stats.stalls = stalls_.load ();
+    stats.truncated = truncated_.load ();
+    stats.writes = writes_.load ();
+    stats.errors = errors_.load ();
+    return stats;
+}  // end Get Stats
+
+// Get Sink
+// - look up the sink without a lock and add it under the lock if it is new.
+// - the extension is .log for text records and .bin for binary blocks
+unsigned int LogWriter::GetSink (const std::string& context,
+                                  const std::string& path,
+                                  const char* extension) {
+    unsigned int count = count_.load (std::memory_order_acquire);
+    for (unsigned int i = 0; i < count; i++) {
+        if (sinks_[i].context == context
+            && sinks_[i].path == path
+            && sinks_[i].extension == extension) {
+            return i;
+        }
+    }
+
+    std::lock_guard <std::mutex> lock (sinks_mutex_);
+    count = count_.load (std::memory_order_relaxed);
+    for (unsigned int i = 0; i < count; i++) {
+        if (sinks_[i].context == context
+            && sinks_[i].path == path
+            && sinks_[i].extension == extension) {
+            return i;
+        }
+    }
+    if (count == kMaxSinks) {
+        errors_.fetch_add (1, std::memory_order_relaxed);
+        return kMaxSinks;
+    }
+    sinks_[count].context = context;
+    sinks_[count].path = path;
+    sinks_[count].extension = extension;
+    count_.store (count + 1, std::memory_order_release);
+    return count;
+}  // end Get Sink
+
+// Write
+// - writer thread, sleeps while there is nothing to write
+void LogWriter::Write () {
+    while (true) {
+        bool done = done_.load ();
+        if (LogWriter::Drain ()) {
+            continue;
+        }
+        if (done) {
+            break;
+        }
+        std::unique_lock <std::mutex> lock (wake_mutex_);
+        wake_cv_.wait_for (lock, std::chrono::milliseconds (5));
+    }
+
+    unsigned int count = count_.load ();
+    for (unsigned int i = 0; i < count; i++) {
+        if (sinks_[i].fd >= 0) {
+            close (sinks_[i].fd);
+        }
+    }
+}  // end Write
+
+// Drain
+// - move the published records and blocks into the sink buffers and write
+// - the buffers. Returns false if there was nothing to write.
+bool LogWriter::Drain () {
+    unsigned int records = 0;
+    while (records < kCapacity) {
+        Slot& slot = ring_[tail_ & (kCapacity - 1)];
+        if (slot.sequence.load (std::memory_order_acquire) != tail_ + 1) {
+            break;
+        }
+        Sink& sink = sinks_[slot.sink];
+        LogWriter::Stamp (slot.time);
+        LogWriter::Append (sink, stamp_date_time_, stamp_length_);
+        sink.buffer.append (slot.text, slot.length);
+        sink.buffer += '\n';
+        slot.sequence.store (tail_ + kCapacity, std::memory_order_release);
+        tail_++;
+        records++;
+    }
+
+    std::vector <Block> blocks;
+    {
+        std::lock_guard <std::mutex> lock (blocks_mutex_);
+        blocks.swap (blocks_);
+    }
+    for (auto &block : blocks) {
+        LogWriter::Stamp (block.time);
+        LogWriter::Append (sinks_[block.sink],
+                           block.bytes.data (),
+                           block.bytes.size ());
+    }
+
+    LogWriter::FlushSinks ();
+    written_.store (tail_);
+    pending_blocks_.fetch_sub (blocks.size ());
+    backlog_->Set (head_.load () - tail_ + pending_blocks_.load ());
+    return records > 0 || !blocks.empty ();
+}  // end Drain
+
+// Append
+// - add bytes to the sink buffer, the file rotates when the date changes.
+// - Stamp must be called with the time first.
+void LogWriter::Append (Sink& sink, const char* bytes, size_t length) {
+    if (sink.date != stamp_date_) {
+        LogWriter::FlushSink (sink);
+        if (sink.fd >= 0) {
+            close (sink.fd);
+            sink.fd = -1;
+        }
+        sink.date = stamp_date_;
+    }
+    sink.buffer.append (bytes, length);
+}  // end Append
+
+// Flush Sinks
+// - one write per sink with everything buffered since the last flush
+void LogWriter::FlushSinks () {
+    unsigned int count = count_.load (std::memory_order_acquire);
+    for (unsigned int i = 0; i < count; i++) {
+        LogWriter::FlushSink (sinks_[i]);
+    }
+}  // end Flush Sinks
+
+// Flush Sink
+// - write the sink buffer, the file is opened for the date of the buffer
+void LogWriter::FlushSink (Sink& sink) {
+    if (sink.buffer.empty ()) {
+        return;
+    }
+    if (sink.fd < 0) {
+        std::string name = sink.path + sink.context + "_" + sink.date
+            + sink.extension;
+        sink.fd = open (name.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+
+    const char* bytes = sink.buffer.data ();
+    size_t remaining = sink.buffer.size ();
+    while (sink.fd >= 0 && remaining > 0) {
+        ssize_t written = write (sink.fd, bytes, remaining);
+        writes_.fetch_add (1, std::memory_order_relaxed);
+        if (written <= 0) {
+            break;
+        }
+        bytes += written;
+        remaining -= written;
+    }
+    if (remaining > 0) {
+        errors_.fetch_add (1, std::memory_order_relaxed);
+    }
+    sink.buffer.clear ();
+}  // end Flush Sink
+
+// Stamp
+// - format the date and the date time once per second
+void LogWriter::Stamp (time_t time) {
+    if (time == stamp_time_) {
+        return;
+    }
+    struct tm ts;
+    localtime_r (&time, &ts);
+    strftime (stamp_date_, sizeof (stamp_date_), "%F", &ts);
+    stamp_length_ = strftime (stamp_date_time_, sizeof (stamp_date_time_),
+                              "%F %T\t", &ts);
+    stamp_time_ = time;
+}  // end Stamp
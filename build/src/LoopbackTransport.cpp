@@ -0,0 +1,122 @@
+#include "include/LoopbackTransport.h"
+
+// constructor
+// - latency and jitter are in milliseconds and loss is the fraction of
+// - commands that never complete. The random seed is fixed so runs repeat.
+LoopbackTransport::LoopbackTransport (unsigned int endpoints,
+                                      unsigned int latency,
+                                      unsigned int jitter,
+                                      double loss)
+    : latency_(std::chrono::milliseconds (latency)),
+      jitter_(jitter),
+      loss_(loss),
+      random_(1),
+      busy_until_(endpoints ? endpoints : 1, Clock::time_point ()),
+      order_(0),
+      delivered_count_(0),
+      lost_count_(0),
+      done_(false) {
+    thread_ = std::thread (&LoopbackTransport::Deliver, this);
+}  // end constructor
+
+// destructor
+// - stop the delivery thread. Commands that have not been delivered are
+// - dropped without completion.
+LoopbackTransport::~LoopbackTransport () {
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        done_ = true;
+    }
+    wake_cv_.notify_all ();
+    thread_.join ();
+}  // end destructor
+
+// Register
+// - the loopback does not use the proxy
+void LoopbackTransport::Register (unsigned long resource,
+                                  ajn::ProxyBusObject &proxy) {
+    (void)proxy;
+    std::lock_guard <std::mutex> lock (mutex_);
+    delivered_.erase (resource);
+}  // end Register
+
+// Unregister
+void LoopbackTransport::Unregister (unsigned long resource) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    delivered_.erase (resource);
+}  // end Unregister
+
+// Send
+// - schedule the command on its endpoint after any commands already there
+void LoopbackTransport::Send (const Command& command, DoneHandler done) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    std::uniform_real_distribution <double> chance (0.0, 1.0);
+    if (loss_ > 0 && chance (random_) < loss_) {
+        lost_count_++;
+        return;
+    }
+
+    std::chrono::microseconds delay = latency_;
+    if (jitter_ > 0) {
+        std::uniform_int_distribution <unsigned int> spread (0, jitter_*1000);
+        delay += std::chrono::microseconds (spread (random_));
+    }
+    Clock::time_point& busy = busy_until_[command.resource % busy_until_.size ()];
+    Clock::time_point now = Clock::now ();
+    busy = (busy > now ? busy : now) + delay;
+
+    Delivery delivery = {busy, order_++, command, std::move (done)};
+    deliveries_.push (std::move (delivery));
+    wake_cv_.notify_one ();
+}  // end Send
+
+// Get Delivered
+// - the last command that reached the resource
+bool LoopbackTransport::GetDelivered (unsigned long resource,
+                                      Command& command) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto found = delivered_.find (resource);
+    if (found == delivered_.end ()) {
+        return false;
+    }
+    command = found->second;
+    return true;
+}  // end Get Delivered
+
+// Get Delivered Count
+unsigned long LoopbackTransport::GetDeliveredCount () {
+    std::lock_guard <std::mutex> lock (mutex_);
+    return delivered_count_;
+}  // end Get Delivered Count
+
+// Get Lost Count
+unsigned long LoopbackTransport::GetLostCount () {
+    std::lock_guard <std::mutex> lock (mutex_);
+    return lost_count_;
+}  // end Get Lost Count
+
+// Deliver
+// - delivery thread that completes the commands in time order. The done
+// - callback is called without the lock since it takes the queue lock.
+void LoopbackTransport::Deliver () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    while (!done_) {
+        if (deliveries_.empty ()) {
+            wake_cv_.wait (lock);
+            continue;
+        }
+        Clock::time_point next = deliveries_.top ().time;
+        if (Clock::now () < next) {
+            wake_cv_.wait_until (lock, next);
+            continue;
+        }
+
+        Delivery delivery = deliveries_.top ();
+        deliveries_.pop ();
+        delivered_[delivery.command.resource] = delivery.command;
+        delivered_count_++;
+        lock.unlock ();
+        delivery.done (true);
+        lock.lock ();
+    }
+}  // end Deliver
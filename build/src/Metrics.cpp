@@ -0,0 +1,278 @@
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include "include/Metrics.h"
+
+// Counter
+Counter::Counter () : value_(0) {
+}  // end constructor
+
+void Counter::Add (uint64_t count) {
+    value_.fetch_add (count, std::memory_order_relaxed);
+}  // end Add
+
+uint64_t Counter::Get () const {
+    return value_.load (std::memory_order_relaxed);
+}  // end Get
+
+// Gauge
+Gauge::Gauge () : value_(0) {
+}  // end constructor
+
+void Gauge::Set (double value) {
+    value_.store (value, std::memory_order_relaxed);
+}  // end Set
+
+double Gauge::Get () const {
+    return value_.load (std::memory_order_relaxed);
+}  // end Get
+
+// Histogram
+Histogram::Histogram () : count_(0), sum_(0), max_(0) {
+    for (auto &bucket : buckets_) {
+        bucket.store (0, std::memory_order_relaxed);
+    }
+}  // end constructor
+
+// Record
+// - add the value to its bucket, safe to call from any thread
+void Histogram::Record (uint64_t value) {
+    buckets_[Histogram::Index (value)].fetch_add (1,
+                                                  std::memory_order_relaxed);
+    count_.fetch_add (1, std::memory_order_relaxed);
+    sum_.fetch_add (value, std::memory_order_relaxed);
+    uint64_t max = max_.load (std::memory_order_relaxed);
+    while (value > max
+           && !max_.compare_exchange_weak (max,
+                                           value,
+                                           std::memory_order_relaxed)) {
+    }
+}  // end Record
+
+uint64_t Histogram::GetCount () const {
+    return count_.load (std::memory_order_relaxed);
+}  // end Get Count
+
+uint64_t Histogram::GetSum () const {
+    return sum_.load (std::memory_order_relaxed);
+}  // end Get Sum
+
+uint64_t Histogram::GetMax () const {
+    return max_.load (std::memory_order_relaxed);
+}  // end Get Max
+
+// Get Quantile
+// - walk the buckets to the rank of the quantile. The buckets are read one
+// - at a time so a quantile taken while recording may be off by the values
+// - recorded during the walk.
+uint64_t Histogram::GetQuantile (double quantile) const {
+    uint64_t count = 0;
+    for (const auto &bucket : buckets_) {
+        count += bucket.load (std::memory_order_relaxed);
+    }
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = std::ceil (quantile * count);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > count) {
+        rank = count;
+    }
+
+    uint64_t max = Histogram::GetMax ();
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < kBuckets; i++) {
+        seen += buckets_[i].load (std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t highest = Histogram::Highest (i);
+            return highest < max ? highest : max;
+        }
+    }
+    return max;
+}  // end Get Quantile
+
+// Index
+// - values below 16 have their own bucket, then each power of two range is
+// - split into 16 buckets
+unsigned int Histogram::Index (uint64_t value) {
+    if (value < kSubBuckets) {
+        return value;
+    }
+    if (value >> kMaxBits) {
+        value = (uint64_t (1) << kMaxBits) - 1;
+    }
+    unsigned int shift = 63 - __builtin_clzll (value) - kSubBits;
+    return (shift + 1) * kSubBuckets + (value >> shift) - kSubBuckets;
+}  // end Index
+
+// Highest
+// - the highest value that falls in the bucket
+uint64_t Histogram::Highest (unsigned int index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    unsigned int shift = index / kSubBuckets - 1;
+    uint64_t sub = index % kSubBuckets + kSubBuckets;
+    return ((sub + 1) << shift) - 1;
+}  // end Highest
+
+// Metrics Timer
+MetricsTimer::MetricsTimer (Histogram& histogram)
+    : histogram_(histogram), start_(Clock::now ()) {
+}  // end constructor
+
+MetricsTimer::~MetricsTimer () {
+    histogram_.Record (std::chrono::duration_cast <std::chrono::nanoseconds>
+                       (Clock::now () - start_).count ());
+}  // end destructor
+
+// constructor
+Metrics::Metrics () {
+}  // end constructor
+
+// Instance
+Metrics& Metrics::Instance () {
+    static Metrics* instance = new Metrics;
+    return *instance;
+}  // end Instance
+
+Counter& Metrics::GetCounter (const std::string& name,
+                              const std::string& help,
+                              const std::string& labels) {
+    return static_cast <Counter&> (Metrics::Get (name, help, labels, COUNTER));
+}  // end Get Counter
+
+Gauge& Metrics::GetGauge (const std::string& name,
+                          const std::string& help,
+                          const std::string& labels) {
+    return static_cast <Gauge&> (Metrics::Get (name, help, labels, GAUGE));
+}  // end Get Gauge
+
+Histogram& Metrics::GetHistogram (const std::string& name,
+                                  const std::string& help,
+                                  const std::string& labels) {
+    return static_cast <Histogram&> (
+        Metrics::Get (name, help, labels, HISTOGRAM));
+}  // end Get Histogram
+
+// Get
+// - find or create the metric, a name can only be used for one type
+Metric& Metrics::Get (const std::string& name,
+                      const std::string& help,
+                      const std::string& labels,
+                      Type type) {
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto found = families_.find (name);
+    if (found == families_.end ()) {
+        Family family;
+        family.type = type;
+        family.help = help;
+        found = families_.emplace (name, std::move (family)).first;
+    } else if (found->second.type != type) {
+        throw std::invalid_argument ("metric type mismatch: " + name);
+    }
+
+    for (auto &series : found->second.series) {
+        if (series.first == labels) {
+            return *series.second;
+        }
+    }
+    std::unique_ptr <Metric> metric;
+    if (type == COUNTER) {
+        metric.reset (new Counter);
+    } else if (type == GAUGE) {
+        metric.reset (new Gauge);
+    } else {
+        metric.reset (new Histogram);
+    }
+    found->second.series.emplace_back (labels, std::move (metric));
+    return *found->second.series.back ().second;
+}  // end Get
+
+// Write
+// - Prometheus text format. Histograms are written as summaries in seconds
+// - with quantile 1 as the max.
+void Metrics::Write (std::ostream& out) {
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    static const char* types[] = {"counter", "gauge", "summary"};
+    std::lock_guard <std::mutex> lock (mutex_);
+    out << std::setprecision (9);
+    for (const auto &entry : families_) {
+        const std::string& name = entry.first;
+        const Family& family = entry.second;
+        out << "# HELP " << name << ' ' << family.help << '\n'
+            << "# TYPE " << name << ' ' << types[family.type] << '\n';
+
+        for (const auto &series : family.series) {
+            const std::string& labels = series.first;
+            std::string braces = labels.empty () ? "" : "{" + labels + "}";
+            if (family.type == COUNTER) {
+                out << name << braces << ' '
+                    << static_cast <const Counter&> (*series.second).Get ()
+                    << '\n';
+                continue;
+            }
+            if (family.type == GAUGE) {
+                out << name << braces << ' '
+                    << static_cast <const Gauge&> (*series.second).Get ()
+                    << '\n';
+                continue;
+            }
+
+            const Histogram& histogram
+                = static_cast <const Histogram&> (*series.second);
+            std::string prefix = labels.empty () ? "" : labels + ",";
+            for (double quantile : quantiles) {
+                out << name << '{' << prefix << "quantile=\"" << quantile
+                    << "\"} " << histogram.GetQuantile (quantile) / 1e9
+                    << '\n';
+            }
+            out << name << '{' << prefix << "quantile=\"1\"} "
+                << histogram.GetMax () / 1e9 << '\n'
+                << name << "_sum" << braces << ' '
+                << histogram.GetSum () / 1e9 << '\n'
+                << name << "_count" << braces << ' '
+                << histogram.GetCount () << '\n';
+        }
+    }
+}  // end Write
+
+// Display Summary
+// - print every metric, histograms in microseconds
+void Metrics::DisplaySummary () {
+    std::lock_guard <std::mutex> lock (mutex_);
+    std::cout << "\nMetrics:" << std::fixed << std::setprecision (1)
+        << std::endl;
+    for (const auto &entry : families_) {
+        for (const auto &series : entry.second.series) {
+            std::string name = entry.first;
+            if (!series.first.empty ()) {
+                name += "{" + series.first + "}";
+            }
+            std::cout << '\t' << std::left << std::setw (52) << name
+                << std::right;
+            if (entry.second.type == COUNTER) {
+                std::cout << static_cast <const Counter&> (*series.second)
+                    .Get () << std::endl;
+                continue;
+            }
+            if (entry.second.type == GAUGE) {
+                std::cout << static_cast <const Gauge&> (*series.second)
+                    .Get () << std::endl;
+                continue;
+            }
+            const Histogram& histogram
+                = static_cast <const Histogram&> (*series.second);
+            std::cout << "count = " << histogram.GetCount ()
+                << ", p50 = " << histogram.GetQuantile (0.5) / 1e3
+                << ", p99 = " << histogram.GetQuantile (0.99) / 1e3
+                << ", p99.9 = " << histogram.GetQuantile (0.999) / 1e3
+                << ", max = " << histogram.GetMax () / 1e3 << " us"
+                << std::endl;
+        }
+    }
+    std::cout.unsetf (std::ios::fixed);
+    std::cout << std::setprecision (6);
+}  // end Display Summary
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "include/Metrics.h"
+#include "include/MetricsServer.h"
+
+// constructor
+// - listen is host:port, a port alone binds to 127.0.0.1, or a socket path
+MetricsServer::MetricsServer (const std::string& listen)
+    : listen_(listen), fd_(-1), done_(false) {
+}  // end constructor
+
+MetricsServer::~MetricsServer () {
+    MetricsServer::Stop ();
+}  // end destructor
+
+// Start
+// - bind the endpoint and start the server thread. An empty listen turns the
+// - endpoint off.
+bool MetricsServer::Start () {
+    if (listen_.empty () || !MetricsServer::Bind ()) {
+        return false;
+    }
+    thread_ = std::thread (&MetricsServer::Serve, this);
+    return true;
+}  // end Start
+
+// Stop
+// - the server thread polls with a timeout so it sees done_ within 200 ms
+void MetricsServer::Stop () {
+    done_ = true;
+    if (thread_.joinable ()) {
+        thread_.join ();
+    }
+    if (fd_ >= 0) {
+        close (fd_);
+        fd_ = -1;
+        if (listen_[0] == '/') {
+            unlink (listen_.c_str ());
+        }
+    }
+}  // end Stop
+
+// Bind
+// - open the listening socket for the endpoint
+bool MetricsServer::Bind () {
+    if (listen_[0] == '/') {
+        sockaddr_un address;
+        std::memset (&address, 0, sizeof (address));
+        address.sun_family = AF_UNIX;
+        if (listen_.size () >= sizeof (address.sun_path)) {
+            std::cout << "[ERROR]: Metrics socket path is too long: "
+                << listen_ << std::endl;
+            return false;
+        }
+        std::strcpy (address.sun_path, listen_.c_str ());
+        // a stale socket from the last run is replaced, anything else at
+        // the path is left alone
+        struct stat status;
+        if (lstat (listen_.c_str (), &status) == 0) {
+            if (!S_ISSOCK (status.st_mode)) {
+                std::cout << "[ERROR]: Metrics socket path exists and is not "
+                    << "a socket: " << listen_ << std::endl;
+                return false;
+            }
+            unlink (listen_.c_str ());
+        }
+        fd_ = socket (AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0
+            || bind (fd_, (sockaddr*) &address, sizeof (address)) != 0
+            || listen (fd_, 8) != 0) {
+            std::cout << "[ERROR]: Metrics could not listen on "
+                << listen_ << ": " << std::strerror (errno) << std::endl;
+            MetricsServer::Close ();
+            return false;
+        }
+        return true;
+    }
+
+    std::string host = "127.0.0.1";
+    std::string port = listen_;
+    std::string::size_type colon = listen_.rfind (':');
+    if (colon != std::string::npos) {
+        host = listen_.substr (0, colon);
+        port = listen_.substr (colon + 1);
+    }
+    sockaddr_in address;
+    std::memset (&address, 0, sizeof (address));
+    address.sin_family = AF_INET;
+    try {
+        address.sin_port = htons (stoul(port));
+    } catch (...) {
+        std::cout << "[ERROR]: Metrics listen is not host:port or a path: "
+            << listen_ << std::endl;
+        return false;
+    }
+    if (inet_pton (AF_INET, host.c_str (), &address.sin_addr) != 1) {
+        std::cout << "[ERROR]: Metrics host is not an IPv4 address: "
+            << host << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    fd_ = socket (AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0
+        || setsockopt (fd_, SOL_SOCKET, SO_REUSEADDR,
+                       &reuse, sizeof (reuse)) != 0
+        || bind (fd_, (sockaddr*) &address, sizeof (address)) != 0
+        || listen (fd_, 8) != 0) {
+        std::cout << "[ERROR]: Metrics could not listen on "
+            << listen_ << ": " << std::strerror (errno) << std::endl;
+        MetricsServer::Close ();
+        return false;
+    }
+    return true;
+}  // end Bind
+
+// Close
+// - close a socket that failed to bind so Stop does not remove the path
+void MetricsServer::Close () {
+    if (fd_ >= 0) {
+        close (fd_);
+        fd_ = -1;
+    }
+}  // end Close
+
+// Serve
+// - server thread, one connection at a time since a scrape is small
+void MetricsServer::Serve () {
+    pollfd listener;
+    listener.fd = fd_;
+    listener.events = POLLIN;
+    while (!done_) {
+        if (poll (&listener, 1, 200) <= 0) {
+            continue;
+        }
+        int client = accept (fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        MetricsServer::Respond (client);
+        close (client);
+    }
+}  // end Serve
+
+// Respond
+// - read the request head and answer with the metrics whatever the path
+void MetricsServer::Respond (int client) {
+    timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt (client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+    setsockopt (client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find ("\r\n\r\n") == std::string::npos
+           && request.size () < 8192) {
+        ssize_t count = recv (client, buffer, sizeof (buffer), 0);
+        if (count <= 0) {
+            break;
+        }
+        request.append (buffer, count);
+    }
+
+    std::ostringstream body;
+    Metrics::Instance ().Write (body);
+    std::string text = body.str ();
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+        << "Content-Type: text/plain; version=0.0.4\r\n"
+        << "Content-Length: " << text.size () << "\r\n"
+        << "Connection: close\r\n\r\n"
+        << text;
+    std::string bytes = response.str ();
+
+    size_t sent = 0;
+    while (sent < bytes.size ()) {
+        ssize_t count = send (client,
+                              bytes.data () + sent,
+                              bytes.size () - sent,
+                              MSG_NOSIGNAL);
+        if (count <= 0) {
+            return;
+        }
+        sent += count;
+    }
+}  // end Respond
@@ -1,25 +1,43 @@
 #include <iostream>
 #include <ctime>
-#include <numeric>
+#include <memory>
 #include "include/Operator.h"
+#include "include/logger.h"
 #include "include/tsu.h"
-#include <cmath>
+
+// FER response times in seconds, the detector hold should cover both
+static const float kFullResponse = 180;
+static const float kRampResponse = 180;
 
 // constructor
 Operator::Operator (std::map <std::string, std::string>& init, 
-					Aggregator* vpp_pointer) 
+					Aggregator* vpp_pointer,
+					TimeSource* clock) 
 					: vpp_ptr_(vpp_pointer),
+					  clock_(clock),
 					  configs_(init),
 					  service_(""),
 					  tou_tier_(0),
-					  pjm_a_index_(0),
-					  pjm_d_index_(0),
-					  eim_index_(0),
+					  pdm_control_(false),
+					  fer_control_(false),
+					  pjm_a_index_(-1),
+					  pjm_d_index_(-1),
+					  eim_index_(-1),
 					  tou_index_(0),
-					  pdm_index_(0),
-					  fer_index_(0),
-					  prev_freqs_(60,60) {
-	// do nothing
+					  pdm_index_(-1),
+					  fer_index_(-1),
+					  fer_detector_(FrequencyDetector::ReadThresholds (init)),
+					  import_power_request_(0),
+					  log_path_(vpp_pointer->GetLogPath ()) {
+	Metrics& metrics = Metrics::Instance ();
+	actions_ = &metrics.GetCounter ("deras_control_actions_total",
+		"Control actions applied from the control channel.",
+		"owner=\"operator\"");
+	lookup_time_ = &metrics.GetHistogram ("deras_schedule_lookup_seconds",
+		"Operator schedule row lookup time.");
+	fer_detector_.SetHandler ([this] (const FrequencyEvent& event) {
+		Operator::FrequencyResponse (event);
+	});
 };
 
 // destructor
@@ -29,7 +47,10 @@ Operator::~Operator () {
 
 // Loop
 // - used to determine which services is active and call appropriate method
+// - after the posted service changes are applied. FER runs on its own
+// - faster period, reference Loop FER
 void Operator::Loop () {
+	actions_->Add (channel_.Drain ());
 	if (service_ == "OFF") {
 		// do nothing
 	} else if (service_ == "PJMA") {
@@ -42,220 +63,201 @@ void Operator::Loop () {
 		Operator::ServiceTOU ();
 	} else if (service_ == "PDM") {
 		Operator::ServicePDM ();
-	} else if (service_ == "FER") {
-		Operator::ServiceFER ();
 	}
 };  // end Loop
 
+// Loop FER
+// - frequency events need a faster response than the schedule services so
+// - FER is its own scheduler task, it does nothing unless FER is active
+void Operator::LoopFER () {
+	if (service_ == "FER") {
+		Operator::ServiceFER ();
+	}
+};  // end Loop FER
+
 // Get Time
 // - return HH:MM:SS formatted time
 std::string Operator::GetTime (time_t utc) {
-	    struct tm ts = *localtime(&utc);
+	    struct tm ts;
+	    localtime_r(&utc, &ts);
 	    char buf[100];
 	    strftime(buf, sizeof(buf), "%T", &ts);
 	    return std::string(buf);
 }
 
 // Set Service
-// - mutator for the service variable
+// - mutator for the service variable. The service is checked and its
+// - schedule is read on the caller's thread, so a slow file does not stall
+// - the scheduler. Only the swap of the loaded schedule is posted to the
+// - operator loop and the last rows are reset so the current row is sent
+// - right away.
 void Operator::SetService (std::string service) {
-	if (service == "PJMA"
-		|| service == "PJMD"
-		|| service == "EIM" 
-		|| service == "TOU" 
-		|| service == "PDM"
-		|| service == "FER"
-		|| service == "OFF") {
-		service_ = service;		
-	} else {
+	if (service != "PJMA" && service != "PJMD" && service != "EIM"
+		&& service != "TOU" && service != "PDM" && service != "FER"
+		&& service != "OFF") {
 		std::cout << "Set Service Error: Invalid service type." << std::endl;
+		return;
 	}
-};  // end Set Service
 
-// Summary
-// - display the current service and the last control sent
-void Operator::Summary () {
-	std::string last_time;
-	float last_control;
-	if (service_ == "OFF") {
-		last_time = 1;
-		last_control = 0;
-	} else if (service_ == "PJMA") {
-		RowPJM& row = schedule_pjm_a_.at(pjm_a_index_);
-		last_time = row.time;
-		last_control = row.normalized_power;
-	} else if (service_ == "PJMD") {
-		RowPJM& row = schedule_pjm_d_.at(pjm_d_index_);
-		last_time = row.time;
-		last_control = row.normalized_power;
-	} else if (service_ == "EIM") {
-		RowEIM& row = schedule_eim_.at(eim_index_);
-		last_time = row.time;
-		last_control = row.normalized_power;
-	} else if (service_ == "TOU") {
-	    time_t now = time(nullptr);
-		last_time = Operator::GetTime (now);
-		last_control = tou_tier_;
-	} else if (service_ == "PDM") {
-		RowPDM& row = schedule_pdm_.at(pdm_index_);
-		last_time = row.time;
-		last_control = pdm_control_;
-	} else if (service_ == "FER") {
-		RowFER& row = schedule_fer_.at(fer_index_);
-		last_time = row.time;
-		last_control = fer_control_;
+	std::shared_ptr <Schedule> schedule (new Schedule);
+	bool loaded = true;
+	if (service == "PJMA") {
+		loaded = Operator::GetPJMA (*schedule);
+	} else if (service == "PJMD") {
+		loaded = Operator::GetPJMD (*schedule);
+	} else if (service == "EIM") {
+		loaded = Operator::GetEIM (*schedule);
+	} else if (service == "PDM") {
+		loaded = Operator::GetPDM (*schedule);
+	} else if (service == "FER") {
+		loaded = Operator::GetFER (*schedule);
+	}
+	if (!loaded) {
+		std::cout << "Set Service Error: " << service
+			<< " schedule could not be loaded." << std::endl;
+		return;
 	}
-	std::cout << "\nOperator:"
-		<< "\n\t service:\t" << service_
-		<< "\n\t last time:\t" << last_time
-		<< "\n\t last control:\t" << last_control << std::endl;
 
+	channel_.Post ([this, service, schedule] {
+		if (service == "PJMA") {
+			schedule_pjm_a_.Swap (*schedule);
+		} else if (service == "PJMD") {
+			schedule_pjm_d_.Swap (*schedule);
+		} else if (service == "EIM") {
+			schedule_eim_.Swap (*schedule);
+		} else if (service == "PDM") {
+			schedule_pdm_.Swap (*schedule);
+		} else if (service == "FER") {
+			schedule_fer_.Swap (*schedule);
+		}
+		service_ = service;
+		pjm_a_index_ = -1;
+		pjm_d_index_ = -1;
+		eim_index_ = -1;
+		pdm_index_ = -1;
+		fer_index_ = -1;
+	});
+};  // end Set Service
+
+// Summary
+// - display the current service and the last control sent from the
+// - operator loop, the time is none until a control is sent. The next
+// - action is run on the operator thread after the summary is printed.
+void Operator::Summary (ControlChannel::Action next) {
+	channel_.Post ([this, next] {
+		std::string last_time = "none";
+		float last_control = 0;
+		if (service_ == "PJMA" && pjm_a_index_ >= 0) {
+			last_time = Schedule::FormatTime (
+				schedule_pjm_a_.GetTime (pjm_a_index_));
+			last_control = schedule_pjm_a_.GetValue (pjm_a_index_);
+		} else if (service_ == "PJMD" && pjm_d_index_ >= 0) {
+			last_time = Schedule::FormatTime (
+				schedule_pjm_d_.GetTime (pjm_d_index_));
+			last_control = schedule_pjm_d_.GetValue (pjm_d_index_);
+		} else if (service_ == "EIM" && eim_index_ >= 0) {
+			last_time = Schedule::FormatTime (
+				schedule_eim_.GetTime (eim_index_));
+			last_control = schedule_eim_.GetValue (eim_index_);
+		} else if (service_ == "TOU") {
+		    time_t now = clock_->Now ();
+			last_time = Operator::GetTime (now);
+			last_control = tou_tier_;
+		} else if (service_ == "PDM" && pdm_index_ >= 0) {
+			last_time = Schedule::FormatTime (
+				schedule_pdm_.GetTime (pdm_index_));
+			last_control = pdm_control_;
+		} else if (service_ == "FER" && fer_index_ >= 0) {
+			last_time = Schedule::FormatTime (
+				schedule_fer_.GetTime (fer_index_));
+			last_control = fer_control_;
+		}
+		std::cout << "\nOperator:"
+			<< "\n\t service:\t" << service_
+			<< "\n\t last time:\t" << last_time
+			<< "\n\t last control:\t" << last_control << std::endl;
+		if (next) {
+			next ();
+		}
+	});
 };  // end Summary
 
 // Get PJM A
-// - read the PJM schedule and format for use
-void Operator::GetPJMA () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["pjma_filepath"], ',', 2);
-	std::string time;
-	float percent_power;
-	schedule_pjm_a_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    // http://man7.org/linux/man-pages/man3/strptime.3.html
-	    time = row.at(0);
-		percent_power = stof (row.at (1));
-		schedule_pjm_a_.emplace_back(time, percent_power);
-	}
+// - read the PJM A schedule, the file may be a CSV or compiled schedule.
+// - returns false if it could not be read or has no rows
+bool Operator::GetPJMA (Schedule& schedule) {
+	return schedule.Load (configs_["pjma_filepath"]) && !schedule.Empty ();
 };  // end Get PJM A
 
 // Get PJM D
-// - read the PJM schedule and format for use
-void Operator::GetPJMD () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["pjmd_filepath"], ',', 2);
-	std::string time;
-	float percent_power;
-	schedule_pjm_d_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    time = row.at(0);
-		percent_power = stof (row.at (1));
-		schedule_pjm_d_.emplace_back(time, percent_power);
-	}
+// - read the PJM D schedule, the file may be a CSV or compiled schedule.
+// - returns false if it could not be read or has no rows
+bool Operator::GetPJMD (Schedule& schedule) {
+	return schedule.Load (configs_["pjmd_filepath"]) && !schedule.Empty ();
 };  // end Get PJM D
 
 // Get EIM
-// - read the EIM schedule and format for use
-void Operator::GetEIM () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["eim_filepath"], ',', 2);
-	std::string time;
-	float percent_power;
-	schedule_eim_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    time = row.at(0);
-		percent_power = stof (row.at (1));
-		std::cout << time << "\t" << percent_power << '\n';
-		schedule_eim_.emplace_back(time, percent_power);
-	}
+// - read the EIM schedule, the file may be a CSV or compiled schedule.
+// - returns false if it could not be read or has no rows
+bool Operator::GetEIM (Schedule& schedule) {
+	return schedule.Load (configs_["eim_filepath"]) && !schedule.Empty ();
 };  // end Get EIM
 
-// Get TOU
-// - read the TOU schedule and format for use
-void Operator::GetTOU () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["tou_filepath"], ',', 3);
-	std::string time;
-	float day_ahead;
-	float real_time;
-	schedule_tou_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    time = row.at(0);
-		day_ahead = stof (row.at (1));
-		real_time = stof (row.at (2));
-		schedule_tou_.emplace_back(time, real_time, day_ahead);
-	}
-};  // end Get TOU
-
 // Get PDM
-// - read the PDM schedule and format for use
-void Operator::GetPDM () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["pdm_filepath"], ',', 2);
-	std::string time;
-	int fahrenheit;
-	schedule_pdm_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    time = row.at(0);
-		fahrenheit = stoi (row.at (1));
-		schedule_pdm_.emplace_back(time, fahrenheit);
-	}
+// - read the PDM schedule, the file may be a CSV or compiled schedule.
+// - returns false if it could not be read or has no rows
+bool Operator::GetPDM (Schedule& schedule) {
+	return schedule.Load (configs_["pdm_filepath"]) && !schedule.Empty ();
 };  // end Get PDM
 
 // Get FER
-// - read the FER schedule and format for use
-void Operator::GetFER () {
-	tsu::string_matrix schedule 
-		= tsu::FileToMatrix (configs_["fer_filepath"], ',', 2);
-	std::string time;
-	float hertz;
-	schedule_fer_.reserve (schedule.size ());
-	schedule.erase (schedule.begin ());  // remove header
-	for (const auto& row : schedule) {
-	    time = row.at(0);
-		hertz = stof (row.at (1));
-		schedule_fer_.emplace_back(time, hertz);
-	}
+// - read the FER schedule, the file may be a CSV or compiled schedule.
+// - returns false if it could not be read or has no rows
+bool Operator::GetFER (Schedule& schedule) {
+	return schedule.Load (configs_["fer_filepath"]) && !schedule.Empty ();
 };  // end Get FER
 
+// Find Row
+// - the row of the schedule that is active at the time
+int Operator::FindRow (const Schedule& schedule, time_t time) {
+	MetricsTimer timer (*lookup_time_);
+	return schedule.Find (Schedule::SecondsOfDay (time));
+};  // end Find Row
+
 // Service PJM Reg A
 // - Reg A is a normalized power control signal that is meant for traditional
 // - regulating resources. Please reference PJM's Manual 12 for more information
 // - The services will used the vpp resource info to determine dispatch and call
 // - the appropriate control method.
 void Operator::ServicePJMA () {
-	// if the schedule has not been read, then load it into memory
-	if (schedule_pjm_a_.empty()) {
-		Operator::GetPJMA ();
+	// find the row that is active now, the control is sent once per row
+	int i = Operator::FindRow (schedule_pjm_a_, clock_->Now ());
+	if (i < 0 || i == pjm_a_index_) {
+		return;
+	}
+	float normalized_power = schedule_pjm_a_.GetValue (i);
+
+	// determine dispatch
+	if (normalized_power > 0) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		float available_watts = vpp_ptr_->GetTotalImportPower ();
+		float dispatch_watts = available_watts * normalized_power;
+		vpp_ptr_->SetImportWatts (dispatch_watts);
+	} else if (normalized_power < 0) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		float available_watts = vpp_ptr_->GetTotalExportPower ();
+		float dispatch_watts = available_watts*(-normalized_power);
+		vpp_ptr_->SetExportWatts (dispatch_watts);
+	} else {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		vpp_ptr_->SetImportWatts (0);
 	}
 
-    time_t now = time(nullptr);
-	std::string time = Operator::GetTime (now);
-
-    // loop through each row of schedule looking for current utc
-    for (unsigned int i = pjm_a_index_; i < schedule_pjm_a_.size(); i++) {
-        RowPJM& row = schedule_pjm_a_.at (i);
-
-
-        if ((row.time == time) && pjm_a_index_ != i) {
-            // if the time is found then determine dispatch
-            if (row.normalized_power > 0) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-            	float available_watts = vpp_ptr_->GetTotalImportPower ();
-            	float dispatch_watts = available_watts * row.normalized_power;
-                vpp_ptr_->SetImportWatts (dispatch_watts);
-            } else if (row.normalized_power < 0) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-            	float available_watts = vpp_ptr_->GetTotalExportPower ();
-            	float dispatch_watts = available_watts*(-row.normalized_power);
-                vpp_ptr_->SetExportWatts (dispatch_watts);
-            } else {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-                vpp_ptr_->SetImportWatts (0);
-            }
-
-            // log index so multiple controls are not sent and to reduce
-            // search time.
-            pjm_a_index_ = i;
-        }
-    }
+	// store row so multiple control signals are not sent
+	pjm_a_index_ = i;
 };  // end Service PJM Reg A
 
 // Service PJM Reg D
@@ -264,43 +266,34 @@ void Operator::ServicePJMA () {
 // - The services will used the vpp resource info to determine dispatch and call
 // - the appropriate control method.
 void Operator::ServicePJMD () {
-	// if the schedule has not been read, then load it into memory
-	if (schedule_pjm_d_.empty()) {
-		Operator::GetPJMD ();
+	// find the row that is active now, the control is sent once per row
+	int i = Operator::FindRow (schedule_pjm_d_, clock_->Now ());
+	if (i < 0 || i == pjm_d_index_) {
+		return;
+	}
+	float normalized_power = schedule_pjm_d_.GetValue (i);
+
+	// determine dispatch
+	if (normalized_power > 0) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		float available_watts = vpp_ptr_->GetTotalImportPower ();
+		float dispatch_watts = available_watts * normalized_power;
+		vpp_ptr_->SetImportWatts (dispatch_watts);
+	} else if (normalized_power < 0) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		float available_watts = vpp_ptr_->GetTotalExportPower ();
+		float dispatch_watts = available_watts*(-normalized_power);
+		vpp_ptr_->SetExportWatts (dispatch_watts);
+	} else {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		vpp_ptr_->SetImportWatts (0);
 	}
 
-    time_t now = time(nullptr);
-	std::string time = Operator::GetTime (now);
-
-    // loop through each row of schedule looking for current utc
-    for (unsigned int i = pjm_d_index_; i < schedule_pjm_d_.size(); i++) {
-        RowPJM& row = schedule_pjm_d_.at (i);
-
-        if ((row.time == time) && pjm_d_index_ != i) {
-
-            // if the time is found then determine dispatch
-            if (row.normalized_power > 0) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-            	float available_watts = vpp_ptr_->GetTotalImportPower ();
-            	float dispatch_watts = available_watts * row.normalized_power;
-                vpp_ptr_->SetImportWatts (dispatch_watts);
-            } else if (row.normalized_power < 0) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-            	float available_watts = vpp_ptr_->GetTotalExportPower ();
-            	float dispatch_watts = available_watts*(-row.normalized_power);
-                vpp_ptr_->SetExportWatts (dispatch_watts);
-            } else {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-                vpp_ptr_->SetImportWatts (0);
-            }
-
-            // store index so multiple control signals are not sent
-            pjm_d_index_ = i;
-        }
-    }
+	// store row so multiple control signals are not sent
+	pjm_d_index_ = i;
 };  // end Service PJM Reg D
 
 // Service EIM
@@ -309,45 +302,34 @@ void Operator::ServicePJMD () {
 // - The services will used the vpp resource info to determine dispatch and call
 // - the appropriate control method.
 void Operator::ServiceEIM () {
-	// if the schedule has not been read, then load it into memory
-	if (schedule_eim_.empty()) {
-		Operator::GetEIM ();
+	// find the row that is active now, the control is sent once per row
+	int i = Operator::FindRow (schedule_eim_, clock_->Now ());
+	if (i < 0 || i == eim_index_) {
+		return;
 	}
-
-    time_t now = time(nullptr);
-	std::string time = Operator::GetTime (now);
-
-    // loop through each row of schedule looking for current utc
-    for (unsigned int i = eim_index_; i < schedule_eim_.size(); i++) {
-        RowEIM& row = schedule_eim_.at (i);
-
-        if ((row.time == time) && eim_index_ != i) {
-
-            // if the time is found then determine dispatch
-            if (row.normalized_power > 0) {
-            	float available_watts = vpp_ptr_->GetTotalImportPower ();
-            	float available_energy = vpp_ptr_->GetTotalImportEnergy ();
-            	float import_time = available_energy / available_watts;
-            	float distribute_power = available_energy / (4*import_time);  // distributed over 4 times the time
-            	float dispatch_watts = distribute_power * row.normalized_power;
-                vpp_ptr_->SetImportWatts (dispatch_watts);
-            } else if (row.normalized_power < 0) {
-            	float available_watts = vpp_ptr_->GetTotalExportPower ();
-            	float available_energy = vpp_ptr_->GetTotalImportEnergy ();
-            	float export_time = available_energy / available_watts;
-            	float distribute_power = available_energy / (4*export_time);  // distributed over 4 times the time
-            	float dispatch_watts = distribute_power * row.normalized_power;
-                vpp_ptr_->SetExportWatts (dispatch_watts);
-            } else {
-                vpp_ptr_->SetImportWatts (0);
-            }
-			// store index so multiple control signals are not sent
-			eim_index_ = i;
-        }
-    }
-	if (eim_index_ == (schedule_eim_.size () - 1)) {
-		eim_index_ = 0;
+	float normalized_power = schedule_eim_.GetValue (i);
+
+	// determine dispatch
+	if (normalized_power > 0) {
+		float available_watts = vpp_ptr_->GetTotalImportPower ();
+		float available_energy = vpp_ptr_->GetTotalImportEnergy ();
+		float import_time = available_energy / available_watts;
+		float distribute_power = available_energy / (4*import_time);  // distributed over 4 times the time
+		float dispatch_watts = distribute_power * normalized_power;
+		vpp_ptr_->SetImportWatts (dispatch_watts);
+	} else if (normalized_power < 0) {
+		float available_watts = vpp_ptr_->GetTotalExportPower ();
+		float available_energy = vpp_ptr_->GetTotalImportEnergy ();
+		float export_time = available_energy / available_watts;
+		float distribute_power = available_energy / (4*export_time);  // distributed over 4 times the time
+		float dispatch_watts = distribute_power * normalized_power;
+		vpp_ptr_->SetExportWatts (dispatch_watts);
+	} else {
+		vpp_ptr_->SetImportWatts (0);
 	}
+
+	// store row so multiple control signals are not sent
+	eim_index_ = i;
 };  // end Service EIM
 
 // Service TOU
@@ -358,13 +340,14 @@ void Operator::ServiceTOU () {
 	// get current utc and modulo the date info out since it isn't required for
 	// our tests.
 	unsigned int seconds_per_day = 60*60*24;
-	time_t time = std::time(nullptr);
+	time_t time = clock_->Now ();
 	unsigned int utc = time % seconds_per_day;
 
 	// Every minute determine TOU tier and set import/export accordingly
     if (utc % 60 == 0 && tou_index_ != utc) {
         // check season for tou tiers
-        struct tm time_info = *std::localtime (&time);
+        struct tm time_info;
+        localtime_r (&time, &time_info);
         int month = time_info.tm_mon + 1;
         int hour = time_info.tm_hour;
         if (month >= MAY && month <= OCT) {
@@ -420,234 +403,105 @@ void Operator::ServiceTOU () {
 // - PDM is the Peak Demand Mitigation and will try to reduce peak power under
 // - specified conditions
 void Operator::ServicePDM () {
-	// if the schedule has not been read, then load it into memory
-	if (schedule_pdm_.empty()) {
-		Operator::GetPDM ();
+	// find the row that is active now, the control is sent once per row
+	time_t time = clock_->Now ();
+	int i = Operator::FindRow (schedule_pdm_, time);
+	if (i < 0 || i == pdm_index_) {
+		return;
+	}
+	int temperature = schedule_pdm_.GetValue (i);
+
+	// get hour info, localtime_r since the log writer thread formats times
+	struct tm time_info;
+	localtime_r (&time, &time_info);
+	int hour = time_info.tm_hour;
+	// determine dispatch
+	if (temperature > 85 && hour >= 18 && hour <= 21) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		vpp_ptr_->SetImportWatts (0);
+		float available_watts = vpp_ptr_->GetTotalExportPower ();
+		vpp_ptr_->SetExportWatts (available_watts);
+		pdm_control_ = true;
+	} else if (temperature < 39 && hour >= 17 && hour <= 20) {
+		std::vector <std::string> targets = {""};
+		vpp_ptr_->SetTargets(targets);
+		vpp_ptr_->SetImportWatts (0);
+		float available_watts = vpp_ptr_->GetTotalExportPower ();
+		vpp_ptr_->SetExportWatts (available_watts);
+		pdm_control_ = true;
+	} else {
+		pdm_control_ = false;
 	}
 
-	// get current utc and modulo the date info out since it isn't required for
-	// our tests.
-	time_t time = std::time(nullptr);
-	std::string f_time = Operator::GetTime (time);
-
-    // loop through each row of schedule looking for current utc
-    for (unsigned int i = pdm_index_; i < schedule_pdm_.size(); i++) {
-        RowPDM& row = schedule_pdm_.at (i);
-
-        if ((row.time == f_time) && pdm_index_ != i) {
-	        // get hour info
-	        struct tm time_info = *std::localtime (&time);
-	        int hour = time_info.tm_hour;
-            // if the time is found then determine dispatch
-            if (row.temperature > 85 && hour >= 18 && hour <= 21) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-                vpp_ptr_->SetImportWatts (0);
-		    	float available_watts = vpp_ptr_->GetTotalExportPower ();
-		        vpp_ptr_->SetExportWatts (available_watts);
-		        pdm_control_ = true;
-            } else if (row.temperature < 39 && hour >= 17 && hour <= 20) {
-            	std::vector <std::string> targets = {""};
-	        	vpp_ptr_->SetTargets(targets);
-                vpp_ptr_->SetImportWatts (0);
-		    	float available_watts = vpp_ptr_->GetTotalExportPower ();
-		        vpp_ptr_->SetExportWatts (available_watts);
-		        pdm_control_ = true;
-            } else {
-            	pdm_control_ = false;
-            }
-
-            // store index so multiple control signals are not sent
-            pdm_index_ = i;
-        }
-    }
+	// store row so multiple control signals are not sent
+	pdm_index_ = i;
 };  // end Service PDM
 
 // Service FER
+// - push the active frequency row to the event detector and run the
+// - response for the active event. An under frequency event stops all import.
+// - An over frequency event imports the requested power for the full
+// - response time and then ramps down to zero.
 void Operator::ServiceFER () {
-	unsigned int actual_time;
-	float actual_hz;
-	float delta_hz;
-	float moving_avg;
-	float floor_freq = 59.975;
-	float min_slew_rate = 0.0031;
-	float ceiling_freq = 120 - floor_freq;
-	float t1 = 180.0/3600;
-	float t2 = t1;
-	float ramp_down_power;
-
-	if (schedule_fer_.empty()) {
-		Operator::GetFER ();
-		std::cout << "File loaded" << std::endl;
+	// find the row that is active now, the control is sent once per row
+	time_t time = clock_->Now ();
+	int i = Operator::FindRow (schedule_fer_, time);
+	if (i < 0 || i == fer_index_) {
+		return;
 	}
-
-	time_t time = std::time(nullptr);
-	std::string f_time = Operator::GetTime (time);
-
-    // loop through each row of schedule looking for current utc
-    for (unsigned int i = fer_index_; i < schedule_fer_.size(); i++) {
-    	RowFER& row = schedule_fer_.at (i);
-
-	if (row.time == f_time && fer_index_ != i) {
-		actual_time = time;
-		actual_hz = row.frequency;
-
-		delta_hz = actual_hz - prev_hz_;
-		prev_hz_ = actual_hz;
-		prev_freqs_.erase(prev_freqs_.begin());
-		prev_freqs_.push_back(actual_hz);
-		moving_avg = accumulate(prev_freqs_.begin(),prev_freqs_.end(),0.0)
-			/ prev_freqs_.size();
-	
-		//std::cout << "time:\t" << actual_time << std::endl;
-		//std::cout << "moving avg:\t" << moving_avg << std::endl;
-		//std::cout << "new freq:\t" << actual_hz << std::endl;
-		std::cout << "delta hz:\t" << delta_hz << std::endl;
-
-		if (actual_hz < floor_freq && actual_hz < moving_avg && delta_hz < 0) {
-			std::cout << "Negative deviation detected"
-				<< "\n\t Actual Hz: " << actual_hz
-				<< "\n\t Moving Avg. : " << moving_avg << std::endl;
-
-			neg_deviation_ = 1;
-		}
-	
-		if (actual_hz > ceiling_freq && actual_hz > moving_avg && delta_hz > 0) {
-			pos_deviation_ = 1;
-		}
-
-		if (neg_deviation_ == 1) {
-			if (oneshot0_ == 1) {
-				oneshot0_ = 0;
-				event_start_hz_ = abs(delta_hz) + actual_hz;
-				event_min_hz_ = 99;
-				event_start_time_ = actual_time;
-			}
-
-			if (actual_hz < event_min_hz_) {
-				event_min_hz_ = actual_hz;
-			} else if ((actual_hz - event_min_hz_) > 0.003) {
-				neg_deviation_ = 0;
-				event_delta_hz_ = 0;
-				event_duration_sec_ = 0;
-			}
-		} else {
-			oneshot0_ = 1;
-		}
-
-		if (pos_deviation_ == 1) {
-			if (oneshot1_ == 1) {
-				oneshot1_ = 0;
-				event_start_hz_ = actual_hz - abs(delta_hz);
-				event_max_hz_ = 0;
-				event_start_time_ = actual_time;
-			}
-
-			if (actual_hz > event_max_hz_) {
-				event_max_hz_ = actual_hz;
-			} else if ((event_max_hz_ - actual_hz) > 0.003) {
-				pos_deviation_ = 0;
-				event_delta_hz_ = 0;
-				event_duration_sec_ = 0;
-			}
-		} else {
-			oneshot1_ = 1;
-		}
-
-		if (neg_deviation_ == 1 && actual_hz < moving_avg) {
-			event_delta_hz_ = event_start_hz_ - actual_hz;
-			event_duration_sec_ = actual_time - event_start_time_;
-		}
-
-		if (pos_deviation_ == 1 && actual_hz > moving_avg) {
-			event_delta_hz_ = actual_hz - event_start_hz_;
-			event_duration_sec_ = actual_time - event_start_time_;
-		}
-
-
-		if (neg_response_timer_ == 1 && neg_response_sec_ <= 360) {
-			neg_event_detected_ = 1;
-			neg_response_sec_ = actual_time - neg_response_start_time_;
-		} else if (neg_deviation_ == 1 && event_duration_sec_ >= 1
-			&& (event_delta_hz_/event_duration_sec_) >= min_slew_rate
-			&& event_delta_hz_ >= (min_slew_rate * 10)) {
-			neg_event_detected_ = 1;
-			neg_response_timer_ = 1;
-			neg_response_start_time_ = actual_time;
-		} else {
-			neg_response_timer_ = 0;
-			neg_response_sec_ = 0;
-			neg_event_detected_ = 0;
-		}
-
-		if (pos_response_timer_ == 1 && pos_response_sec_ <= 360) {
-			pos_event_detected_ = 1;
-			pos_response_sec_ = actual_time - pos_response_start_time_;
-		} else if (pos_deviation_ == 1 && event_duration_sec_ >= 1
-			&& (event_delta_hz_/event_duration_sec_) >= min_slew_rate
-			&& event_delta_hz_ >= (min_slew_rate * 10)) {
-			pos_event_detected_ = 1;
-			pos_response_timer_ = 1;
-			pos_response_start_time_ = actual_time;
-		} else {
-			pos_response_timer_ = 0;
-			pos_response_sec_ = 0;
-			pos_event_detected_ = 0;
-		}	
-
-		if (neg_event_detected_ == 1) {
-			pos_response_timer_ = 0;
-			pos_response_sec_ = 0;
-			pos_event_detected_ = 0;
-		}
-
-		//Log positive and negative event detection here
-		
-		if (neg_event_detected_ == 1) {
-			std::cout << "Negative event: " 
-				<< "\n\t time : " << actual_time << std::endl;
-		} else if (pos_event_detected_ == 1) {
-			std::cout << "Positive event: " 
-				<< "\n\t time : " << actual_time << std::endl;
-		}
-		
-
-		//Positive Response Algorithm
-		if (pos_event_detected_ == 1 && pos_response_start_time_ == actual_time) {
-			unsigned int total_import_energy = vpp_ptr_->GetTotalImportEnergy ();
-			std::cout << "Response total import energy:\t" << total_import_energy << std::endl;
-			float import_request = total_import_energy*pow(t1 + t2/2,-1);
-			unsigned int max_import_power = vpp_ptr_->GetTotalImportPower ();
-			if (import_request > max_import_power) {
-				import_request = max_import_power;
-			}
-			std::cout << "Response P (float):\t" << import_request << std::endl;
-			//import_power_request_ = total_import_energy*pow(t1 + t2/2,-1);
-			import_power_request_ = import_request;
-			std::cout << "Response P:\t" << import_power_request_ << std::endl;
-		}
-
-		if (pos_event_detected_ == 1 && pos_response_sec_ < 180) {
+	fer_index_ = i;
+	fer_detector_.Push (time, schedule_fer_.GetValue (i));
+
+	bool under = fer_detector_.IsActive (FrequencyEvent::UNDER);
+	bool over = fer_detector_.IsActive (FrequencyEvent::OVER);
+	fer_control_ = under || over;
+	if (under) {
+		vpp_ptr_->SetImportWatts (0);
+	} else if (over) {
+		float elapsed = fer_detector_.GetElapsed (FrequencyEvent::OVER, time);
+		if (elapsed < kFullResponse) {
 			vpp_ptr_->SetImportWatts (import_power_request_);
-			std::cout << "Positive event response, import:\t" << import_power_request_ << std::endl;
-		} else if (pos_event_detected_ == 1 && pos_response_sec_ < 360) {
-			ramp_down_power = (1 - (pos_response_sec_-180)/180.0)*import_power_request_;
+		} else if (elapsed < kFullResponse + kRampResponse) {
+			float ramp_down_power = (1 - (elapsed - kFullResponse)
+				/ kRampResponse) * import_power_request_;
 			vpp_ptr_->SetImportWatts (ramp_down_power);
-			std::cout << "Event time elapsed:\t" << pos_response_sec_ << std::endl;			
-			std::cout << "Positive event response, ramp down import:\t" << ramp_down_power << std::endl;
-		} else if (pos_event_detected_ == 1 && pos_response_sec_ == 360) {
+		} else {
 			vpp_ptr_->SetImportWatts (0);
 		}
+	}
+};  // end Service FER
 
-		//Negative Response Algorithm
-		if (neg_event_detected_ == 1 && neg_response_sec_ < 360) {
-			vpp_ptr_->SetImportWatts (0);
-			std::cout << "Negative event response, import set to 0" << std::endl;
+// Frequency Response
+// - called by the detector for each frequency event. When an over frequency
+// - event starts the import request is sized so the available import energy
+// - covers the full response and the ramp down. The recovery does not stop
+// - the import, the response ramps down over the detector hold time.
+// - The event is logged through the background writer since this runs on
+// - the scheduler thread.
+void Operator::FrequencyResponse (const FrequencyEvent& event) {
+	const char* types[] = {"start", "nadir", "recovery"};
+	const char* directions[] = {"under", "over"};
+	Logger("Frequency", log_path_, clock_->Now ())
+		<< types[event.type] << '\t'
+		<< directions[event.direction] << '\t'
+		<< Operator::GetTime (event.time) << '\t'
+		<< event.hz << '\t'
+		<< Operator::GetTime (event.start_time) << '\t'
+		<< event.start_hz << '\t'
+		<< Operator::GetTime (event.extreme_time) << '\t'
+		<< event.extreme_hz;
+
+	if (event.direction != FrequencyEvent::OVER) {
+		return;
+	}
+	if (event.type == FrequencyEvent::START) {
+		float hours = (kFullResponse + kRampResponse / 2) / 3600;
+		float import_request = vpp_ptr_->GetTotalImportEnergy () / hours;
+		unsigned int max_import_power = vpp_ptr_->GetTotalImportPower ();
+		if (import_request > max_import_power) {
+			import_request = max_import_power;
 		}
-
-		fer_index_ = i;
+		import_power_request_ = import_request;
 	}
-}
-
-	
-};  // end Service FER
+};  // end Frequency Response
@@ -0,0 +1,273 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include "include/Schedule.h"
+
+namespace {
+    const char kMagic[4] = {'D', 'E', 'R', 'S'};
+    const uint32_t kVersion = 1;
+    const unsigned int kSecondsPerDay = 60*60*24;
+}
+
+// constructor
+Schedule::Schedule () : columns_(0), step_(0) {
+    // do nothing
+}  // end constructor
+
+Schedule::~Schedule () {
+    // do nothing
+}  // end destructor
+
+// Load
+// - read a compiled schedule if the file starts with the magic, otherwise
+// - parse it as a CSV file
+bool Schedule::Load (const std::string& filename) {
+    char magic[4] = {0};
+    std::ifstream file (filename, std::ios::binary);
+    if (!file) {
+        std::cout << "[ERROR]...schedule not found: " << filename << std::endl;
+        return false;
+    }
+    file.read (magic, sizeof (magic));
+    file.close ();
+    if (std::memcmp (magic, kMagic, sizeof (magic)) == 0) {
+        return Schedule::LoadBinary (filename);
+    }
+    return Schedule::LoadCSV (filename);
+}  // end Load
+
+// Load CSV
+// - stream the file one line at a time. The first column is the H:MM:SS or
+// - HH:MM:SS start time and the other columns are values. A header row is
+// - skipped if the first line does not start with a time.
+bool Schedule::LoadCSV (const std::string& filename) {
+    std::ifstream file (filename);
+    if (!file) {
+        std::cout << "[ERROR]...schedule not found: " << filename << std::endl;
+        return false;
+    }
+
+    Schedule::Clear ();
+    std::string line;
+    std::vector <float> values;
+    unsigned int line_number = 0;
+    while (std::getline (file, line)) {
+        line_number++;
+        if (!line.empty () && line.back () == '\r') {
+            line.pop_back ();
+        }
+        if (line.empty ()) {
+            continue;
+        }
+        if (line_number == 1 && !isdigit (line[0])) {
+            continue;  // header
+        }
+
+        const char* cursor = line.c_str ();
+        char* end;
+        unsigned long hours = strtoul (cursor, &end, 10);
+        bool valid = *end == ':';
+        unsigned long minutes = strtoul (end + valid, &end, 10);
+        valid = valid && *end == ':';
+        unsigned long seconds = strtoul (end + valid, &end, 10);
+        valid = valid && minutes < 60 && seconds < 60;
+
+        values.clear ();
+        while (valid && *end == ',') {
+            cursor = end + 1;
+            values.push_back (strtof (cursor, &end));
+            valid = end != cursor;
+        }
+        valid = valid && *end == '\0' && !values.empty ();
+
+        if (!valid || !Schedule::Append (hours*3600 + minutes*60 + seconds,
+                                         values)) {
+            std::cout << "[ERROR]...schedule " << filename
+                << " line " << line_number << ": " << line << std::endl;
+            Schedule::Clear ();
+            return false;
+        }
+    }
+    return true;
+}  // end Load CSV
+
+// Load Binary
+// - read a schedule written by Save
+bool Schedule::LoadBinary (const std::string& filename) {
+    std::ifstream file (filename, std::ios::binary);
+    if (!file) {
+        std::cout << "[ERROR]...schedule not found: " << filename << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t header[3];  // version, rows, columns
+    file.read (magic, sizeof (magic));
+    file.read (reinterpret_cast <char*> (header), sizeof (header));
+    if (!file
+        || std::memcmp (magic, kMagic, sizeof (magic)) != 0
+        || header[0] != kVersion
+        || header[2] == 0) {
+        std::cout << "[ERROR]...invalid schedule: " << filename << std::endl;
+        return false;
+    }
+
+    Schedule::Clear ();
+    columns_ = header[2];
+    times_.resize (header[1]);
+    values_.resize (size_t (header[1]) * columns_);
+    file.read (reinterpret_cast <char*> (times_.data ()),
+               times_.size () * sizeof (unsigned int));
+    file.read (reinterpret_cast <char*> (values_.data ()),
+               values_.size () * sizeof (float));
+    if (!file || !Schedule::Index ()) {
+        std::cout << "[ERROR]...invalid schedule: " << filename << std::endl;
+        Schedule::Clear ();
+        return false;
+    }
+    return true;
+}  // end Load Binary
+
+// Save
+// - write the schedule in the binary format
+bool Schedule::Save (const std::string& filename) {
+    std::ofstream file (filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "[ERROR]...unable to write: " << filename << std::endl;
+        return false;
+    }
+
+    uint32_t header[3] = {kVersion, uint32_t (times_.size ()), columns_};
+    file.write (kMagic, sizeof (kMagic));
+    file.write (reinterpret_cast <const char*> (header), sizeof (header));
+    file.write (reinterpret_cast <const char*> (times_.data ()),
+                times_.size () * sizeof (unsigned int));
+    file.write (reinterpret_cast <const char*> (values_.data ()),
+                values_.size () * sizeof (float));
+    return bool (file);
+}  // end Save
+
+// Append
+// - add a row after the last row. The rows must be in time order within one
+// - day and have the same number of values.
+bool Schedule::Append (unsigned int seconds,
+                       const std::vector <float>& values) {
+    if (columns_ == 0) {
+        columns_ = values.size ();
+    }
+    if (values.size () != columns_ || values.empty ()
+        || seconds >= kSecondsPerDay
+        || (!times_.empty () && seconds <= times_.back ())) {
+        return false;
+    }
+
+    if (times_.size () == 1) {
+        step_ = seconds - times_.back ();
+    } else if (times_.size () > 1 && seconds - times_.back () != step_) {
+        step_ = 0;
+    }
+    times_.push_back (seconds);
+    values_.insert (values_.end (), values.begin (), values.end ());
+    return true;
+}  // end Append
+
+// Find
+// - return the row that is active at the seconds of the day or -1 if the
+// - schedule is empty
+int Schedule::Find (unsigned int seconds) const {
+    if (times_.empty ()) {
+        return -1;
+    }
+    if (seconds < times_.front ()) {
+        return times_.size () - 1;  // still in the last row of yesterday
+    }
+    if (step_) {
+        unsigned int row = (seconds - times_.front ()) / step_;
+        return std::min <unsigned int> (row, times_.size () - 1);
+    }
+    auto next = std::upper_bound (times_.begin (), times_.end (), seconds);
+    return (next - times_.begin ()) - 1;
+}  // end Find
+
+// Get Time
+// - the start of the row as seconds of the day
+unsigned int Schedule::GetTime (unsigned int row) const {
+    return times_[row];
+}  // end Get Time
+
+// Get Value
+float Schedule::GetValue (unsigned int row, unsigned int column) const {
+    return values_[size_t (row) * columns_ + column];
+}  // end Get Value
+
+// Size
+// - number of rows
+unsigned int Schedule::Size () const {
+    return times_.size ();
+}  // end Size
+
+// Columns
+// - number of values per row
+unsigned int Schedule::Columns () const {
+    return columns_;
+}  // end Columns
+
+// Empty
+bool Schedule::Empty () const {
+    return times_.empty ();
+}  // end Empty
+
+// Clear
+void Schedule::Clear () {
+    times_.clear ();
+    values_.clear ();
+    columns_ = 0;
+    step_ = 0;
+}  // end Clear
+
+// Swap
+// - exchange the rows with another schedule without copying them
+void Schedule::Swap (Schedule& other) {
+    times_.swap (other.times_);
+    values_.swap (other.values_);
+    std::swap (columns_, other.columns_);
+    std::swap (step_, other.step_);
+}  // end Swap
+
+// Seconds Of Day
+// - local time of day in seconds, the schedules use local time
+unsigned int Schedule::SecondsOfDay (time_t utc) {
+    struct tm ts;
+    localtime_r (&utc, &ts);
+    return ts.tm_hour*3600 + ts.tm_min*60 + ts.tm_sec;
+}  // end Seconds Of Day
+
+// Format Time
+// - return HH:MM:SS formatted seconds of the day
+std::string Schedule::FormatTime (unsigned int seconds) {
+    char buf[16];
+    snprintf (buf, sizeof (buf), "%02u:%02u:%02u",
+              seconds / 3600, seconds / 60 % 60, seconds % 60);
+    return std::string (buf);
+}  // end Format Time
+
+// Index
+// - check the row order and find the step after a binary load
+bool Schedule::Index () {
+    step_ = times_.size () > 1 ? times_[1] - times_[0] : 0;
+    for (unsigned int i = 0; i < times_.size (); i++) {
+        if (times_[i] >= kSecondsPerDay
+            || (i > 0 && times_[i] <= times_[i - 1])) {
+            return false;
+        }
+        if (i > 0 && times_[i] - times_[i - 1] != step_) {
+            step_ = 0;
+        }
+    }
+    return true;
+}  // end Index
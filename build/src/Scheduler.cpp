@@ -0,0 +1,183 @@
+#include <iostream>
+#include <iomanip>
+#include <pthread.h>
+#include <sched.h>
+#include "include/Scheduler.h"
+
+// constructor
+Scheduler::Scheduler () : done_(false) {
+}  // end constructor
+
+// destructor
+Scheduler::~Scheduler () {
+    Scheduler::Stop ();
+}  // end destructor
+
+// Add Task
+// - add a task with its period in milliseconds. Tasks must be added before
+// - the scheduler is started and run in the order they were added when
+// - their deadlines are equal.
+void Scheduler::AddTask (const std::string& name,
+                         unsigned int period,
+                         Task task) {
+    if (period == 0) {
+        period = 1;
+    }
+    Entry entry;
+    entry.task = task;
+    entry.period = std::chrono::milliseconds (period);
+    Metrics& metrics = Metrics::Instance ();
+    std::string labels = "task=\"" + name + "\"";
+    entry.run = &metrics.GetHistogram ("deras_task_run_seconds",
+                                       "Scheduler task run time.",
+                                       labels);
+    entry.late = &metrics.GetHistogram ("deras_task_late_seconds",
+                                        "Scheduler task lateness.",
+                                        labels);
+    entry.missed = &metrics.GetCounter ("deras_task_missed_total",
+                                        "Scheduler task periods skipped.",
+                                        labels);
+    entries_.push_back (entry);
+
+    TaskStats stats = TaskStats ();
+    stats.name = name;
+    stats.period = period;
+    stats_.push_back (stats);
+}  // end Add Task
+
+// Start
+// - start the loop thread, every task runs right away and then on its
+// - period. If cpu is not negative the thread is pinned to that cpu.
+void Scheduler::Start (int cpu) {
+    Clock::time_point now = Clock::now ();
+    for (auto &entry : entries_) {
+        entry.deadline = now;
+        entry.last_run = now;
+    }
+    thread_ = std::thread (&Scheduler::Run, this);
+
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO (&cpus);
+        CPU_SET (cpu, &cpus);
+        if (pthread_setaffinity_np (thread_.native_handle (),
+                                    sizeof (cpus),
+                                    &cpus) != 0) {
+            std::cout << "[ERROR]: Scheduler could not pin to cpu "
+                << cpu << std::endl;
+        }
+    }
+}  // end Start
+
+// Stop
+// - wake the loop thread and wait for the running task to finish
+void Scheduler::Stop () {
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        done_ = true;
+    }
+    wake_cv_.notify_all ();
+    if (thread_.joinable ()) {
+        thread_.join ();
+    }
+}  // end Stop
+
+// Get Stats
+// - copy of the deadline accounting for every task
+std::vector <TaskStats> Scheduler::GetStats () {
+    std::lock_guard <std::mutex> lock (mutex_);
+    return stats_;
+}  // end Get Stats
+
+// Display Summary
+// - print the deadline accounting, times are in microseconds
+void Scheduler::DisplaySummary () {
+    std::vector <TaskStats> stats = Scheduler::GetStats ();
+    std::cout << "\nScheduler:" << std::endl;
+    for (const auto &task : stats) {
+        unsigned long mean = task.runs ? task.total_run / task.runs : 0;
+        std::cout << "\t" << std::left << std::setw (12) << task.name
+            << std::right
+            << " period = " << task.period << " ms"
+            << ", runs = " << task.runs
+            << ", missed = " << task.missed
+            << ", overruns = " << task.overruns
+            << ", max late = " << task.max_late << " us"
+            << ", run = " << mean << "/" << task.max_run << " us"
+            << std::endl;
+    }
+}  // end Display Summary
+
+// Run
+// - loop thread that sleeps until the earliest deadline and runs that task.
+// - a task that starts one or more periods late skips the periods it missed
+// - so the next deadline stays on its original phase.
+void Scheduler::Run () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    while (!done_) {
+        if (entries_.empty ()) {
+            wake_cv_.wait (lock, [this] { return done_; });
+            continue;
+        }
+        unsigned int i = Scheduler::Next ();
+        Entry& entry = entries_[i];
+        if (wake_cv_.wait_until (lock, entry.deadline, [this] {
+                return done_;
+            })) {
+            break;
+        }
+        lock.unlock ();
+
+        Clock::time_point start = Clock::now ();
+        Clock::duration late = start - entry.deadline;
+        if (late < Clock::duration::zero ()) {
+            late = Clock::duration::zero ();
+        }
+        unsigned long missed = late / entry.period;
+        std::chrono::duration <float, std::milli> delta_time
+            = start - entry.last_run;
+        entry.task (delta_time.count ());
+        Clock::duration run = Clock::now () - start;
+        entry.last_run = start;
+        entry.deadline += entry.period * (missed + 1);
+        entry.run->Record (std::chrono::duration_cast
+            <std::chrono::nanoseconds> (run).count ());
+        entry.late->Record (std::chrono::duration_cast
+            <std::chrono::nanoseconds> (late).count ());
+        if (missed) {
+            entry.missed->Add (missed);
+        }
+
+        lock.lock ();
+        TaskStats& stats = stats_[i];
+        unsigned long late_us = std::chrono::duration_cast
+            <std::chrono::microseconds> (late).count ();
+        unsigned long run_us = std::chrono::duration_cast
+            <std::chrono::microseconds> (run).count ();
+        stats.runs++;
+        stats.missed += missed;
+        if (run > entry.period) {
+            stats.overruns++;
+        }
+        if (late_us > stats.max_late) {
+            stats.max_late = late_us;
+        }
+        if (run_us > stats.max_run) {
+            stats.max_run = run_us;
+        }
+        stats.total_run += run_us;
+    }
+}  // end Run
+
+// Next
+// - index of the task with the earliest deadline. There are only a few
+// - tasks so a scan is cheaper than keeping a heap ordered.
+unsigned int Scheduler::Next () {
+    unsigned int next = 0;
+    for (unsigned int i = 1; i < entries_.size (); i++) {
+        if (entries_[i].deadline < entries_[next].deadline) {
+            next = i;
+        }
+    }
+    return next;
+}  // end Next
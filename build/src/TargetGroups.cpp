@@ -0,0 +1,115 @@
+#include "include/TargetGroups.h"
+
+// constructor
+TargetGroups::TargetGroups () {
+    // do nothing
+}  // end constructor
+
+TargetGroups::~TargetGroups () {
+    // do nothing
+}  // end destructor
+
+// Add
+// - append a resource path at the next fleet id and set its membership for
+// - every known group
+void TargetGroups::Add (const std::string& path) {
+    unsigned int id = paths_.size ();
+    paths_.push_back (path);
+    for (unsigned int group = 0; group < members_.size (); group++) {
+        bool found = path.find (targets_[group]) != std::string::npos;
+        TargetGroups::Assign (members_[group], id, found);
+    }
+}  // end Add
+
+// Remove
+// - move the last resource into the removed id to match the fleet state
+void TargetGroups::Remove (unsigned int id) {
+    unsigned int last = paths_.size () - 1;
+    paths_[id] = paths_[last];
+    paths_.pop_back ();
+    for (auto &bits : members_) {
+        TargetGroups::Assign (bits, id, TargetGroups::Test (bits, last));
+        TargetGroups::Assign (bits, last, false);
+        bits.resize ((paths_.size () + 63) / 64);
+    }
+}  // end Remove
+
+// Is Member
+// - a resource is a target if its path contains every target argument
+bool TargetGroups::IsMember (unsigned int id,
+                             const std::vector <std::string>& targets) {
+    for (const auto &target : targets) {
+        unsigned int group = TargetGroups::Intern (target);
+        if (!TargetGroups::Test (members_[group], id)) {
+            return false;
+        }
+    }
+    return true;
+}  // end Is Member
+
+// Match
+// - AND the group bitsets of the targets and expand the result to the mask.
+// - if target arguments is empty, then default to all resources
+void TargetGroups::Match (const std::vector <std::string>& targets,
+                          std::vector <unsigned char>& mask) {
+    Bitset result ((paths_.size () + 63) / 64, ~uint64_t (0));
+    for (const auto &target : targets) {
+        const Bitset& bits = members_[TargetGroups::Intern (target)];
+        for (unsigned int word = 0; word < result.size (); word++) {
+            result[word] &= bits[word];
+        }
+    }
+
+    mask.resize (paths_.size ());
+    for (unsigned int id = 0; id < paths_.size (); id++) {
+        mask[id] = TargetGroups::Test (result, id);
+    }
+}  // end Match
+
+// Size
+// - number of resources in the groups
+unsigned int TargetGroups::Size () {
+    return paths_.size ();
+}  // end Size
+
+// Intern
+// - return the group id of the target and build its membership the first
+// - time it is seen
+unsigned int TargetGroups::Intern (const std::string& target) {
+    auto found = groups_.find (target);
+    if (found != groups_.end ()) {
+        return found->second;
+    }
+
+    unsigned int group = members_.size ();
+    Bitset bits ((paths_.size () + 63) / 64, 0);
+    for (unsigned int id = 0; id < paths_.size (); id++) {
+        if (paths_[id].find (target) != std::string::npos) {
+            TargetGroups::Assign (bits, id, true);
+        }
+    }
+    groups_[target] = group;
+    targets_.push_back (target);
+    members_.push_back (std::move (bits));
+    return group;
+}  // end Intern
+
+// Test
+// - check the membership bit of a fleet id
+bool TargetGroups::Test (const Bitset& bits, unsigned int id) {
+    return (bits[id / 64] >> (id % 64)) & 1;
+}  // end Test
+
+// Assign
+// - set or clear the membership bit of a fleet id
+void TargetGroups::Assign (Bitset& bits, unsigned int id, bool value) {
+    if (id / 64 >= bits.size ()) {
+        bits.resize (id / 64 + 1, 0);
+    }
+    uint64_t bit = uint64_t (1) << (id % 64);
+    if (value) {
+        bits[id / 64] |= bit;
+    } else {
+        bits[id / 64] &= ~bit;
+    }
+}  // end Assign
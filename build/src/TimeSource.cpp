@@ -0,0 +1,45 @@
+#include "include/TimeSource.h"
+
+namespace {
+    // System Time
+    // - the wall clock
+    class SystemTime : public TimeSource {
+    public:
+        time_t Now () {
+            return time (nullptr);
+        };
+    };
+}
+
+// System
+TimeSource* TimeSource::System () {
+    static SystemTime system;
+    return &system;
+}  // end System
+
+// constructor
+SimulatedTime::SimulatedTime (time_t start) : start_(start), elapsed_(0) {
+    // do nothing
+}  // end constructor
+
+SimulatedTime::~SimulatedTime () {
+    // do nothing
+}  // end destructor
+
+// Now
+// - the start time plus the whole seconds advanced
+time_t SimulatedTime::Now () {
+    return start_ + elapsed_ / 1000;
+}  // end Now
+
+// Advance
+// - move the simulated time forward
+void SimulatedTime::Advance (unsigned int milliseconds) {
+    elapsed_ += milliseconds;
+}  // end Advance
+
+// Get Elapsed
+// - milliseconds since the start time
+unsigned long long SimulatedTime::GetElapsed () {
+    return elapsed_;
+}  // end Get Elapsed
@@ -3,19 +3,35 @@
 // - DER descovered by AllJoyn. The aggregator is used to send remote control
 // - signals to each DER through their respective DCS and emulates the DER
 // - response to reduce network traffic. 
+// - The aggregator is owned by the scheduler thread that calls Loop. The
+// - mutators and displays may be called from any thread, they are posted to
+// - the control channel and applied in order at the start of the next Loop.
+// - The getters are only for tasks on the scheduler thread.
 
 #ifndef AGGREGATOR_H_INCLUDED
 #define AGGREGATOR_H_INCLUDED
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "tsu.h"
+#include "CommandQueue.h"
+#include "ControlChannel.h"
+#include "CommandTransport.h"
 #include "DistributedEnergyResource.h"
+#include "DispatchIndex.h"
+#include "FleetState.h"
+#include "Metrics.h"
+#include "TargetGroups.h"
+#include "TimeSource.h"
 
 class Aggregator {
 public:
     // constructor / destructor
-    Aggregator (tsu::config_map &init);
+    Aggregator (tsu::config_map &init,
+                TimeSource* clock = TimeSource::System ());
     virtual ~Aggregator ();
     // accessor / mutators
     void SetTargets (const std::vector <std::string> &targets);
@@ -28,51 +44,98 @@ public:
     unsigned int GetTotalExportPower ();
     unsigned int GetTotalImportEnergy ();
     unsigned int GetTotalImportPower ();
+    unsigned int GetExportWatts ();
+    unsigned int GetImportWatts ();
+    float GetExportPower ();
+    float GetImportPower ();
     unsigned int GetTime ();
     int GetPrice ();
     int GetTemperature ();
+    std::string GetLogPath ();
+    CommandStats GetCommandStats ();
     // aggregator methods
     void AddResource (std::map <std::string, unsigned int>& init,
                       ajn::ProxyBusObject &proxy
     );
+    void AddResource (std::map <std::string, unsigned int>& init,
+                      const std::string& uid,
+                      const std::string& path
+    );
     void UpdateResource (std::map <std::string, unsigned int>& init,
-                         const std::string& path
+                         const std::string& uid
     );
-    void RemoveResource (const std::string& path);
+    void RemoveResource (const std::string& uid);
     void Loop (float delta_time);
     void DisplayAllResources ();
     void DisplayTargetResources ();
-    void DisplaySummary ();
+    void DisplaySummary (ControlChannel::Action next = nullptr);
 
 private:
     // config map
     tsu::config_map config_;
+    TimeSource* clock_;
+    // actions posted by the operator, CLI and client listener
+    ControlChannel channel_;
     // logging
     unsigned int last_log_;
     unsigned int log_inc_;
     std::string log_path_;
+    bool log_binary_;
+    // command pipeline
+    // - every resource gets a key that is kept when its fleet id moves
+    std::unique_ptr <CommandTransport> transport_;
+    std::unique_ptr <CommandQueue> queue_;
+    std::atomic <unsigned long> next_key_;
     // aggregate
+    // - resources_ is aligned with the fleet state rows by fleet id
+    FleetState fleet_;
     std::vector <std::shared_ptr <DistributedEnergyResource>> resources_;
-    std::vector <std::shared_ptr <DistributedEnergyResource>> sub_resources_;
+    // - UID to fleet id, a DCS may own more than one resource
+    std::unordered_multimap <std::string, unsigned int> uids_;
+    TargetGroups groups_;
+    DispatchIndex index_;
     // dispatch variables
     // - these variables represent the filtered total resources
+    // - fleet_.target marks the resources that match the targets
     std::vector <std::string> targets_;
     unsigned int total_export_energy_;
     unsigned int total_export_power_;
     unsigned int total_import_energy_;
     unsigned int total_import_power_;
+    // - the digital twin power of the filtered resources
+    float export_power_;
+    float import_power_;
     // control properties
     unsigned int export_watts_;
     unsigned int import_watts_;
     int price_;
     unsigned int time_;
     int temperature_;
+    // metrics, the dispatch phases are labeled deras_dispatch_seconds
+    Counter* actions_;
+    Histogram* twins_time_;
+    Histogram* totals_time_;
+    Histogram* filter_time_;
+    Histogram* export_time_;
+    Histogram* import_time_;
+    Gauge* resource_count_;
+    Gauge* export_gauge_;
+    Gauge* import_gauge_;
+    Gauge* pending_gauge_;
+    Gauge* in_flight_gauge_;
     // control methods
+    void InsertResource (std::map <std::string, unsigned int>& init,
+                         unsigned long key,
+                         const std::string& uid,
+                         const std::string& path);
     void FilterResources ();
+    void RemoveAt (unsigned int id);
+    void EraseUID (const std::string& uid, unsigned int id);
     void ExportPower ();
     void ImportPower ();
     void UpdateTotals ();
     void Log ();
+    void LogBinary (unsigned int utc);
 };
 
 #endif // AGGREGATOR_H_INCLUDED
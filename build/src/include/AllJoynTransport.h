@@ -0,0 +1,51 @@
+// Description: this transport sends the DER control signals to the remote
+// - DCS through the alljoyn proxy bus objects. The method call is made
+// - asynchronously and the command is completed by the method reply or
+// - failed by the reply timeout. A reply timeout of zero opts in to sending
+// - the calls without a reply like the original control signals, the
+// - commands are then completed as soon as they are sent.
+// - The pending replies are tracked and the destructor waits for them, so
+// - the transport is deleted while the bus is still running and alljoyn can
+// - answer every pending call with its reply or a timeout error.
+
+#ifndef ALLJOYNTRANSPORT_H_INCLUDED
+#define ALLJOYNTRANSPORT_H_INCLUDED
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/MessageReceiver.h>
+#include "CommandTransport.h"
+
+class AllJoynTransport : public CommandTransport,
+                         public ajn::MessageReceiver {
+public:
+    // constructor / destructor
+    AllJoynTransport (const std::string& interface,
+                      unsigned int reply_timeout);
+    virtual ~AllJoynTransport ();
+    // transport methods
+    void Register (unsigned long resource, ajn::ProxyBusObject &proxy);
+    void Unregister (unsigned long resource);
+    void Send (const Command& command, DoneHandler done);
+
+private:
+    void Reply (ajn::Message& message, void* context);
+
+private:
+    std::string interface_;
+    unsigned int reply_timeout_;  // ms, zero for no reply
+    // proxies, pending and replying_ are guarded by mutex_
+    std::mutex mutex_;
+    std::unordered_map <unsigned long, ajn::ProxyBusObject> proxies_;
+    // handlers owned by method calls waiting on a reply and the number of
+    // replies running their handler
+    std::unordered_set <DoneHandler*> pending_;
+    unsigned int replying_;
+    std::condition_variable drained_cv_;
+};
+
+#endif // ALLJOYNTRANSPORT_H_INCLUDED
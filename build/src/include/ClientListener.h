@@ -31,6 +31,7 @@
 #define CLIENTLISTENER_H_INCLUDED
 
 #include "Aggregator.h"
+#include "Metrics.h"
 
 class ClientListener : public ajn::MessageReceiver,
                        public ajn::Observer::Listener,
@@ -54,6 +55,10 @@ private:
     ajn::Observer* obs_ptr_;
     Aggregator* vpp_ptr_;
 
+    // metrics
+    Counter* discovered_;
+    Counter* lost_;
+    Counter* changed_;
 
     // properties
     const char* client_interface_;
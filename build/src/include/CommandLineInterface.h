@@ -11,11 +11,14 @@
 #include <string>
 #include "Aggregator.h"
 #include "Operator.h"
+#include "Scheduler.h"
 
 class CommandLineInterface {
     public:
         // constructor / destructor
-        CommandLineInterface (Aggregator* vpp, Operator* opr);
+        CommandLineInterface (Aggregator* vpp,
+                              Operator* opr,
+                              Scheduler* scheduler = nullptr);
         virtual ~CommandLineInterface ();
         void Help ();
         bool Control (const std::string& input);
@@ -23,6 +26,7 @@ class CommandLineInterface {
     private:
         Aggregator* vpp_ptr_;
         Operator* oper_ptr_;
+        Scheduler* scheduler_ptr_;
 
 };  // end Command Line Interface
 
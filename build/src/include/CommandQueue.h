@@ -0,0 +1,86 @@
+// Description: this class is the outbound command pipeline between the
+// - aggregator and the remote devices. Commands are queued per resource and a
+// - newer command replaces an older one that has not been sent yet. A pool of
+// - worker threads hands the commands to the transport so a slow or dead DCS
+// - can not stall the control loop. Each resource has at most one command in
+// - flight and commands that are not completed within the timeout are
+// - dropped so the next command can go out.
+
+#ifndef COMMANDQUEUE_H_INCLUDED
+#define COMMANDQUEUE_H_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CommandTransport.h"
+#include "Metrics.h"
+
+// Command Stats
+// - counters used to watch the pipeline for backpressure
+struct CommandStats {
+    unsigned long pushed;       // commands from the aggregator
+    unsigned long coalesced;    // commands replaced before they were sent
+    unsigned long sent;         // commands handed to the transport
+    unsigned long completed;    // commands delivered
+    unsigned long failed;       // commands the transport rejected
+    unsigned long timed_out;    // commands without completion in time
+    unsigned long late;         // completions after timeout or removal
+    unsigned int pending;       // resources waiting to send
+    unsigned int max_pending;   // high water mark of pending
+    unsigned int in_flight;     // resources waiting on completion
+};
+
+class CommandQueue {
+public:
+    // constructor / destructor
+    CommandQueue (CommandTransport* transport,
+                  unsigned int workers,
+                  unsigned int timeout);
+    virtual ~CommandQueue ();
+    // queue methods
+    void Push (const Command& command);
+    void Cancel (unsigned long resource);
+    void Stop ();
+    CommandStats GetStats ();
+    void DisplaySummary ();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot {
+        Command pending;
+        bool queued;
+        bool in_flight;
+        unsigned long sequence;
+        Clock::time_point sent;
+    };
+
+private:
+    void Work ();
+    void Complete (unsigned long resource, unsigned long sequence, bool ok);
+    void Expire (Clock::time_point now);
+
+private:
+    // class composition
+    CommandTransport* transport_;
+    std::chrono::milliseconds timeout_;
+    // the slots, ready queue and deadlines are guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::unordered_map <unsigned long, Slot> slots_;
+    std::deque <unsigned long> ready_;
+    std::multimap <Clock::time_point,
+                   std::pair <unsigned long, unsigned long>> deadlines_;
+    CommandStats stats_;
+    Histogram* latency_;
+    Counter* timeouts_;
+    bool done_;
+    std::vector <std::thread> workers_;
+};
+
+#endif // COMMANDQUEUE_H_INCLUDED
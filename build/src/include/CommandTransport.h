@@ -0,0 +1,38 @@
+// Description: a command transport delivers DER control signals to the
+// - remote devices for the CommandQueue. Sending is asynchronous and the
+// - transport calls the done callback once the command was delivered or
+// - failed. AllJoynTransport talks to the DCS through proxy bus objects and
+// - LoopbackTransport fakes the DCS endpoints for offline testing.
+
+#ifndef COMMANDTRANSPORT_H_INCLUDED
+#define COMMANDTRANSPORT_H_INCLUDED
+
+#include <functional>
+#include <alljoyn/ProxyBusObject.h>
+
+// Command
+// - the control signal sent to a single resource
+struct Command {
+    enum Method {
+        EXPORT_POWER, IMPORT_POWER
+    };
+
+    unsigned long resource;  // resource key assigned by the aggregator
+    Method method;
+    unsigned int watts;
+};
+
+class CommandTransport {
+public:
+    typedef std::function <void (bool ok)> DoneHandler;
+
+    virtual ~CommandTransport () {};
+    // resources are registered with their proxy when they are discovered
+    virtual void Register (unsigned long resource,
+                           ajn::ProxyBusObject &proxy) = 0;
+    virtual void Unregister (unsigned long resource) = 0;
+    // send must not block on the remote device
+    virtual void Send (const Command& command, DoneHandler done) = 0;
+};
+
+#endif // COMMANDTRANSPORT_H_INCLUDED
@@ -0,0 +1,37 @@
+// Description: this class passes control actions to the thread that owns an
+// - object. Any thread may post an action and the owner runs the actions in
+// - the order they were posted when it drains the channel at the start of
+// - its loop. The queue is a lock-free multiple producer single consumer
+// - list so posting never waits on the owner.
+
+#ifndef CONTROLCHANNEL_H_INCLUDED
+#define CONTROLCHANNEL_H_INCLUDED
+
+#include <atomic>
+#include <functional>
+
+class ControlChannel {
+public:
+    typedef std::function <void ()> Action;
+
+    // constructor / destructor
+    ControlChannel ();
+    virtual ~ControlChannel ();
+    // channel methods
+    void Post (Action action);
+    unsigned int Drain ();
+
+private:
+    struct Node {
+        std::atomic <Node*> next;
+        Action action;
+    };
+
+private:
+    // producers swap themselves in at head_, the owner follows tail_ which
+    // is the last node it consumed
+    std::atomic <Node*> head_;
+    Node* tail_;
+};
+
+#endif // CONTROLCHANNEL_H_INCLUDED
@@ -0,0 +1,152 @@
+// Description: this class keeps the target resources ordered for dispatch so
+// - the aggregator does not have to re-sort every resource on every loop.
+// - Two orders are kept, one for export and one for import, using the ramp
+// - rate first and then available energy. The energy is bucketed and each
+// - (ramp, bucket) holds an intrusive list, so re-keying a resource is O(1).
+// - Each order keeps a cut, the last resource selected to meet the watts,
+// - and the rated watts selected so far. A dispatch only moves the cut by the
+// - change in watts and commands the resources that crossed it.
+// - A resource is only re-keyed when its energy may have left its bucket.
+// - The index knows how fast a digital twin can move energy, reference
+// - FleetState::Loop, so each resource is put on a timer wheel for the time
+// - it could first cross a bucket edge. The timers are set again whenever a
+// - resource is commanded or updated.
+
+#ifndef DISPATCHINDEX_H_INCLUDED
+#define DISPATCHINDEX_H_INCLUDED
+
+#include <functional>
+#include <map>
+#include <vector>
+#include <memory>
+#include "DistributedEnergyResource.h"
+#include "FleetState.h"
+
+class DispatchIndex {
+public:
+    // constructor / destructor
+    // - the twins are read from the fleet state rows of the resources and
+    // - bucket is the energy bucket width in Wh
+    DispatchIndex (FleetState* fleet, unsigned int bucket = 100);
+    virtual ~DispatchIndex ();
+    // index methods
+    void Insert (DistributedEnergyResource* der);
+    void Erase (DistributedEnergyResource* der);
+    void Update (DistributedEnergyResource* der);
+    void Refresh (float delta_time);
+    void Clear ();
+    unsigned int Size ();
+    // dispatch methods
+    void ExportPower (unsigned int watts);
+    void ImportPower (unsigned int watts);
+
+private:
+    enum Direction {
+        EXPORT, IMPORT
+    };
+
+    // the timer wheel has a slot for each kResolution milliseconds, later
+    // timers wait for a recheck
+    static const unsigned int kWheel = 8192;
+    static const unsigned int kResolution = 100;
+    // the timers allow ticks this much longer or shorter than recent ticks
+    static constexpr float kMargin = 1.25;
+
+    struct Entry;
+    struct Bucket {
+        Entry* head;
+        Entry* tail;
+    };
+
+    // the resources with one ramp rate, buckets are indexed by energy
+    struct Level {
+        std::vector <Bucket> buckets;
+        unsigned int count;
+    };
+
+    // greatest ramp first
+    typedef std::map <unsigned int, Level, std::greater <unsigned int>> Order;
+
+    // position of an entry in one order, its rated power and dispatch state
+    struct Node {
+        Entry* prev;
+        Entry* next;
+        Order::iterator level;
+        unsigned int ramp;
+        unsigned int bucket;
+        unsigned int power;
+        bool selected;          // at or before the cut
+        bool touched;           // waiting in touched_ for a command check
+        unsigned long wake;     // slot of the timer, 0 for none
+    };
+
+    // the entries are stored by fleet id so their addresses do not change
+    // when the slots grow
+    struct Entry {
+        DistributedEnergyResource* der;
+        Node node[2];
+    };
+
+    // timers and touched entries hold the fleet id so an erased entry is
+    // skipped instead of left dangling
+    struct Timer {
+        unsigned int id;
+        Direction direction;
+        unsigned long wake;
+    };
+
+private:
+    Entry* Find (DistributedEnergyResource* der);
+    Entry* Find (unsigned int id);
+    unsigned int GetRamp (Entry* entry, Direction direction);
+    unsigned int GetPower (Entry* entry, Direction direction);
+    float GetEnergy (Entry* entry, Direction direction);
+    unsigned int GetBucket (Entry* entry, Direction direction);
+    unsigned int GetRatedEnergy (Entry* entry, Direction direction);
+    void Link (Entry* entry,
+               Direction direction,
+               unsigned int ramp,
+               unsigned int bucket);
+    void Unlink (Entry* entry, Direction direction);
+    void Relink (Entry* entry,
+                 Direction direction,
+                 unsigned int ramp,
+                 unsigned int bucket);
+    bool Rekey (Entry* entry, Direction direction);
+    void Reload (Entry* entry, Direction direction);
+    void Schedule (Entry* entry, Direction direction);
+    Entry* Next (Entry* entry, Direction direction);
+    Entry* Prev (Entry* entry, Direction direction);
+    bool Selects (Entry* entry, Direction direction);
+    void Select (Entry* entry, Direction direction);
+    void Deselect (Entry* entry, Direction direction);
+    void Touch (Entry* entry, Direction direction);
+    void Dispatch (Direction direction, unsigned int watts);
+
+private:
+    FleetState* fleet_;
+    unsigned int bucket_;
+    std::vector <std::unique_ptr <Entry>> slots_;
+    unsigned int size_;
+    Order orders_[2];
+    // the last selected entry and the rated watts at or before it
+    Entry* cut_[2];
+    unsigned long selected_[2];
+    // entries whose selection changed since the last dispatch
+    std::vector <unsigned int> touched_[2];
+    // timer wheel indexed by slot modulo kWheel, the clock sums the ticks
+    // in milliseconds and slot_ is the last slot that was run
+    std::vector <std::vector <Timer>> wheel_;
+    std::vector <Timer> next_;
+    std::vector <Timer> due_;
+    double elapsed_;
+    unsigned long slot_;
+    // the range of ticks the timers allow and the range of ticks in this
+    // turn of the wheel, in milliseconds
+    float bound_;
+    float floor_;
+    float longest_;
+    float shortest_;
+};
+
+#endif // DISPATCHINDEX_H_INCLUDED
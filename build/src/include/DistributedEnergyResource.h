@@ -1,27 +1,31 @@
 // Author: Tylor Slay
 // Description: This class serves as a base class for DER. It is used as the 
 // - digitial twin of the remote device and allows the aggregator to control
-// - through alljoyn proxy bus object method calls.
+// - through commands pushed to the CommandQueue. The twin properties are
+// - stored in a FleetState row so this object only holds the cold data.
 
 #ifndef DISTRIBUTED_ENERGY_RESOURCE_H_
 #define DISTRIBUTED_ENERGY_RESOURCE_H_
 
 #include <map>
 #include <string>
-#include <alljoyn/ProxyBusObject.h>
+#include "CommandQueue.h"
+#include "FleetState.h"
 
 class DistributedEnergyResource {
     public:
         // constructor / destructor
         DistributedEnergyResource (
-            std::map <std::string, unsigned int> &init,
-            ajn::ProxyBusObject &proxy,
-            std::string interface
+            FleetState* fleet,
+            unsigned int id,
+            CommandQueue* queue,
+            unsigned long key,
+            std::string uid,
+            std::string path
         );
         virtual ~DistributedEnergyResource ();
         void RemoteExportPower (unsigned int power);
         void RemoteImportPower (unsigned int power);
-        void Loop (float delta_time);
         void Print ();
 
     public:
@@ -55,40 +59,24 @@ class DistributedEnergyResource {
         // set idle methods
         void SetIdleLosses (unsigned int energy_per_hour);
         unsigned int GetIdleLosses ();  
-        std::string GetPath ();
-        std::string GetUID ();
+        const std::string& GetPath ();
+        const std::string& GetUID ();
+        // fleet row
+        void SetID (unsigned int id);
+        unsigned int GetID ();
+        unsigned long GetKey ();
         
     private:
         // class composition
-        ajn::ProxyBusObject proxy_;
-        
-    private:
-        // controls
-        void ImportPower ();
-        void ExportPower ();
-        void IdleLoss ();
+        FleetState* fleet_;
+        CommandQueue* queue_;
 
     private:
-        // rated export properties
-        unsigned int rated_export_power_;       // (W) to grid
-        unsigned int rated_export_energy_;      // (Wh)
-        unsigned int export_ramp_;              // (W s^-1)
-        // rated import properties
-        unsigned int rated_import_power_;       // (W) from grid
-        unsigned int rated_import_energy_;      // (Wh)
-        unsigned int import_ramp_;              // (W s^-1)
-        // rated idle properties
-        unsigned int idle_losses_;              // (Wh h^-1)
-        // dynamic properties
-        float export_power_;
-        float export_energy_;
-        float import_power_;
-        float import_energy_;     
-        // control properties
-        unsigned int export_watts_;
-        unsigned int import_watts_;
-        float delta_time_;  // milliseconds
-        std::string interface_;
+        unsigned int id_;
+        // the command key does not change when the fleet id moves
+        unsigned long key_;
+        std::string uid_;
+        std::string path_;
 };
 
 #endif // DISTRIBUTED_ENERGY_RESOURCE_H_
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Description: this class stores the digital twin state of every DER in
+// - contiguous columns keyed by a dense resource id. The aggregator updates
+// - the whole fleet in a single pass over the columns instead of calling
+// - each DER object. DistributedEnergyResource objects are handles to a row
+// - and hold the cold data such as the AllJoyn proxy.
+
+#ifndef FLEETSTATE_H_INCLUDED
+#define FLEETSTATE_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+class FleetState {
+public:
+    // constructor / destructor
+    FleetState ();
+    virtual ~FleetState ();
+    // fleet methods
+    unsigned int Add (std::map <std::string, unsigned int> &init);
+    void Remove (unsigned int id);
+    void Reserve (unsigned int size);
+    unsigned int Size ();
+    void Loop (float delta_time);
+
+public:
+    // rated export properties
+    std::vector <unsigned int> rated_export_power;     // (W) to grid
+    std::vector <unsigned int> rated_export_energy;    // (Wh)
+    std::vector <unsigned int> export_ramp;            // (W s^-1)
+    // rated import properties
+    std::vector <unsigned int> rated_import_power;     // (W) from grid
+    std::vector <unsigned int> rated_import_energy;    // (Wh)
+    std::vector <unsigned int> import_ramp;            // (W s^-1)
+    // rated idle properties
+    std::vector <unsigned int> idle_losses;            // (Wh h^-1)
+    // dynamic properties
+    std::vector <float> export_power;
+    std::vector <float> export_energy;
+    std::vector <float> import_power;
+    std::vector <float> import_energy;
+    // control properties
+    std::vector <unsigned int> export_watts;
+    std::vector <unsigned int> import_watts;
+    // aggregator target filter (1 = target resource)
+    std::vector <unsigned char> target;
+};
+
+#endif // FLEETSTATE_H_INCLUDED
@@ -0,0 +1,132 @@
+// Description: streaming detector for the frequency events used by the FER
+// - service. Samples are pushed in time order at any rate, from the one
+// - second schedule rows up to PMU streams, or as a batch for backtesting.
+// - The moving average is a fixed ring buffer with a running sum so a sample
+// - is O(1) and nothing is allocated after construction.
+// - A deviation starts when the frequency leaves the floor or ceiling band
+// - while it is beyond the moving average and still moving away. It ends when
+// - the frequency rebounds from its extreme. A deviation becomes an event when
+// - its change from the starting frequency meets the delta and slew rate
+// - thresholds. The event recovers when the averaged frequency is back in
+// - the band. The event is also active for the hold time, a lockout that
+// - lets the response run and keeps the event from starting again, so an
+// - event can recover while it is still active. An under frequency event
+// - cancels the lockout of an over frequency event.
+// - The handler is called when an event starts, when its nadir (or peak) is
+// - known and when it recovers.
+
+#ifndef FREQUENCYDETECTOR_H_INCLUDED
+#define FREQUENCYDETECTOR_H_INCLUDED
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Frequency Thresholds
+// - frequencies are in Hz and times in seconds
+struct FrequencyThresholds {
+    unsigned int window;    // samples in the moving average
+    float floor;            // under frequency band
+    float ceiling;          // over frequency band
+    float slew;             // minimum Hz per second from the start
+    float delta;            // minimum Hz from the start
+    float rebound;          // Hz back from the extreme that ends a deviation
+    float hold;             // seconds an event stays active
+};
+
+// Frequency Event
+// - the event reported to the handler
+struct FrequencyEvent {
+    enum Type {
+        START, NADIR, RECOVERY
+    };
+    enum Direction {
+        UNDER, OVER
+    };
+
+    Type type;
+    Direction direction;
+    double time;            // sample that raised the report
+    float hz;
+    double start_time;      // sample where the deviation started
+    float start_hz;         // frequency before the deviation
+    double extreme_time;    // lowest (under) or highest (over) frequency
+    float extreme_hz;
+};
+
+class FrequencyDetector {
+public:
+    typedef std::function <void (const FrequencyEvent& event)> EventHandler;
+
+    // constructor / destructor
+    FrequencyDetector (const FrequencyThresholds& thresholds,
+                       float nominal = 60);
+    virtual ~FrequencyDetector ();
+    // detector methods
+    void SetHandler (EventHandler handler);
+    void Reset ();
+    void Push (double time, float hz);
+    void Push (const double* times, const float* hz, unsigned int count);
+    bool IsActive (FrequencyEvent::Direction direction) const;
+    double GetElapsed (FrequencyEvent::Direction direction, double time) const;
+    float GetMovingAverage () const;
+    const FrequencyThresholds& GetThresholds () const;
+    // read the fer_ thresholds from the operator configuration
+    static FrequencyThresholds ReadThresholds (
+        std::map <std::string, std::string>& init
+    );
+
+private:
+    struct Deviation {
+        bool active;
+        bool resume;        // ended on the last sample
+        double start_time;
+        float start_hz;
+        double extreme_time;
+        float extreme_hz;
+        // change from the start while the frequency is beyond the average
+        float delta_hz;
+        double duration;
+    };
+
+    struct Event {
+        bool active;        // in the hold time
+        bool open;          // started and not recovered
+        bool nadir;         // the extreme was reported
+        double time;        // sample that started the event
+        FrequencyEvent record;
+    };
+
+private:
+    void Track (FrequencyEvent::Direction direction,
+                double time,
+                float hz,
+                float previous_hz,
+                float average);
+    void Detect (FrequencyEvent::Direction direction, double time, float hz);
+    void Recover (FrequencyEvent::Direction direction,
+                  double time,
+                  float hz,
+                  float average);
+    void Cancel (FrequencyEvent::Direction direction);
+    void Emit (FrequencyEvent::Type type,
+               Event& event,
+               double time,
+               float hz);
+
+private:
+    FrequencyThresholds thresholds_;
+    float nominal_;
+    EventHandler handler_;
+    // moving average ring buffer
+    std::vector <float> window_;
+    unsigned int head_;
+    double sum_;
+    float previous_hz_;
+    // indexed by direction
+    Deviation deviations_[2];
+    Event events_[2];
+};
+
+#endif // FREQUENCYDETECTOR_H_INCLUDED
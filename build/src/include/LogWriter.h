@@ -0,0 +1,130 @@
+// Description: this class is the background writer behind Logger. Records
+// - are copied into a bounded lock-free ring by any thread and a single
+// - writer thread drains the ring, adds the timestamp and appends the
+// - records to one file per context and date with one write per file for
+// - each batch. The timestamp text is formatted once per second and the
+// - files rotate when the date of the records changes. Binary telemetry
+// - blocks are queued whole and written to a .bin file the same way.
+// - A full ring makes the logging thread wait for the writer so no record
+// - is lost, the stalls are counted in the stats.
+
+#ifndef LOGWRITER_H_INCLUDED
+#define LOGWRITER_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+
+// Log Stats
+// - counters used to watch the logger
+struct LogStats {
+    unsigned long records;     // text records pushed
+    unsigned long blocks;      // binary blocks pushed
+    unsigned long stalls;      // pushes that waited on a full ring
+    unsigned long truncated;   // text records longer than a slot
+    unsigned long writes;      // write calls made by the writer
+    unsigned long errors;      // files that could not be opened or written
+};
+
+class LogWriter {
+public:
+    // the text of a record must fit in one ring slot
+    static const unsigned int kTextSize = 232;
+    static const unsigned int kCapacity = 16384;  // power of 2
+    static const unsigned int kMaxSinks = 64;     // invalid sink id
+
+    // constructor / destructor
+    LogWriter ();
+    virtual ~LogWriter ();
+    // the process wide writer used by Logger
+    static LogWriter& Instance ();
+    // writer methods
+    // - a sink id is looked up once per record or block by context and path
+    unsigned int GetSink (const std::string& context,
+                          const std::string& path,
+                          const char* extension);
+    void Push (unsigned int sink,
+               time_t time,
+               const char* text,
+               unsigned int length);
+    void PushBlock (unsigned int sink, time_t time, std::string&& bytes);
+    void Flush ();
+    LogStats GetStats ();
+
+private:
+    struct Slot {
+        std::atomic <size_t> sequence;
+        int64_t time;
+        uint16_t sink;
+        uint16_t length;
+        char text[kTextSize];
+    };
+
+    struct Block {
+        int64_t time;
+        unsigned int sink;
+        std::string bytes;
+    };
+
+    // a sink is a log file by context and extension, the date is added when
+    // the file is opened. Sinks are only added so readers do not lock.
+    struct Sink {
+        std::string context;
+        std::string path;
+        std::string extension;
+        // writer thread only
+        int fd;
+        std::string date;
+        std::string buffer;
+    };
+
+private:
+    void Write ();
+    bool Drain ();
+    void Append (Sink& sink, const char* bytes, size_t length);
+    void FlushSinks ();
+    void FlushSink (Sink& sink);
+    void Stamp (time_t time);
+
+private:
+    // ring, head_ is shared by the producers and tail_ is the writer's
+    std::unique_ptr <Slot[]> ring_;
+    std::atomic <size_t> head_;
+    size_t tail_;
+    // sinks, count_ publishes the sinks that are ready to read
+    Sink sinks_[kMaxSinks];
+    std::atomic <unsigned int> count_;
+    std::mutex sinks_mutex_;
+    // binary blocks are rare and large so they use a locked list
+    std::mutex blocks_mutex_;
+    std::vector <Block> blocks_;
+    // writer thread
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic <size_t> written_;
+    std::atomic <unsigned long> pending_blocks_;
+    std::atomic <bool> done_;
+    std::thread thread_;
+    // timestamp cache, writer thread only
+    time_t stamp_time_;
+    char stamp_date_[16];
+    char stamp_date_time_[32];
+    unsigned int stamp_length_;
+    // stats
+    std::atomic <unsigned long> records_;
+    std::atomic <unsigned long> blocks_count_;
+    std::atomic <unsigned long> stalls_;
+    std::atomic <unsigned long> truncated_;
+    std::atomic <unsigned long> writes_;
+    std::atomic <unsigned long> errors_;
+    Gauge* backlog_;
+};
+
+#endif // LOGWRITER_H_INCLUDED
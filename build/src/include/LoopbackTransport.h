@@ -0,0 +1,76 @@
+// Description: this transport fakes the remote DCS endpoints so the command
+// - pipeline can be exercised without an alljoyn network. Resources are
+// - spread over the endpoints by key and each endpoint handles its commands
+// - one at a time after the configured latency and jitter. A lost command is
+// - never completed so the queue has to time it out. The last command that
+// - reached each resource is kept for the offline tools.
+
+#ifndef LOOPBACKTRANSPORT_H_INCLUDED
+#define LOOPBACKTRANSPORT_H_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CommandTransport.h"
+
+class LoopbackTransport : public CommandTransport {
+public:
+    // constructor / destructor
+    LoopbackTransport (unsigned int endpoints,
+                       unsigned int latency,
+                       unsigned int jitter,
+                       double loss);
+    virtual ~LoopbackTransport ();
+    // transport methods
+    void Register (unsigned long resource, ajn::ProxyBusObject &proxy);
+    void Unregister (unsigned long resource);
+    void Send (const Command& command, DoneHandler done);
+    // loopback methods
+    bool GetDelivered (unsigned long resource, Command& command);
+    unsigned long GetDeliveredCount ();
+    unsigned long GetLostCount ();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Delivery {
+        Clock::time_point time;
+        unsigned long order;
+        Command command;
+        DoneHandler done;
+        // earliest delivery on top of the priority queue
+        bool operator< (const Delivery& other) const {
+            if (time != other.time) {
+                return time > other.time;
+            }
+            return order > other.order;
+        }
+    };
+
+private:
+    void Deliver ();
+
+private:
+    std::chrono::microseconds latency_;
+    unsigned int jitter_;  // ms
+    double loss_;
+    // everything below is guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::mt19937 random_;
+    std::vector <Clock::time_point> busy_until_;
+    std::priority_queue <Delivery> deliveries_;
+    std::unordered_map <unsigned long, Command> delivered_;
+    unsigned long order_;
+    unsigned long delivered_count_;
+    unsigned long lost_count_;
+    bool done_;
+    std::thread thread_;
+};
+
+#endif // LOOPBACKTRANSPORT_H_INCLUDED
@@ -0,0 +1,138 @@
+// Description: process wide instrumentation. Components register counters,
+// - gauges and latency histograms by name once and then update them from any
+// - thread without locks. Histograms are HDR style, each power of two range
+// - is split into 16 linear buckets so a recorded value is kept within about
+// - 6% from a nanosecond up to minutes in a fixed array of counters.
+// - The registry writes every metric in the Prometheus text format for the
+// - scrape endpoint, reference MetricsServer, and as a table for the CLI.
+// - Durations are recorded in nanoseconds and exported in seconds.
+
+#ifndef METRICS_H_INCLUDED
+#define METRICS_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Metric {
+public:
+    virtual ~Metric () {};
+};
+
+// Counter
+// - a total that only goes up
+class Counter : public Metric {
+public:
+    Counter ();
+    void Add (uint64_t count = 1);
+    uint64_t Get () const;
+
+private:
+    std::atomic <uint64_t> value_;
+};
+
+// Gauge
+// - a value that is set by its owner
+class Gauge : public Metric {
+public:
+    Gauge ();
+    void Set (double value);
+    double Get () const;
+
+private:
+    std::atomic <double> value_;
+};
+
+// Histogram
+// - log linear buckets of nanoseconds
+class Histogram : public Metric {
+public:
+    static const unsigned int kSubBits = 4;
+    static const unsigned int kSubBuckets = 1 << kSubBits;
+    static const unsigned int kMaxBits = 40;  // values are capped at 2^40
+    static const unsigned int kBuckets = (kMaxBits - kSubBits + 1)
+                                       * kSubBuckets;
+
+    Histogram ();
+    void Record (uint64_t value);
+    uint64_t GetCount () const;
+    uint64_t GetSum () const;
+    uint64_t GetMax () const;
+    // the highest value in the bucket that holds the quantile
+    uint64_t GetQuantile (double quantile) const;
+
+private:
+    static unsigned int Index (uint64_t value);
+    static uint64_t Highest (unsigned int index);
+
+private:
+    std::atomic <uint64_t> buckets_[kBuckets];
+    std::atomic <uint64_t> count_;
+    std::atomic <uint64_t> sum_;
+    std::atomic <uint64_t> max_;
+};
+
+// Metrics Timer
+// - records the nanoseconds from construction to destruction
+class MetricsTimer {
+public:
+    explicit MetricsTimer (Histogram& histogram);
+    ~MetricsTimer ();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    Histogram& histogram_;
+    Clock::time_point start_;
+};
+
+class Metrics {
+public:
+    // the registry is never destroyed so metrics can be updated while the
+    // process exits
+    static Metrics& Instance ();
+    // metrics are created on first use and the same name and labels return
+    // the same metric. Labels are written as name="value",name="value".
+    Counter& GetCounter (const std::string& name,
+                         const std::string& help,
+                         const std::string& labels = "");
+    Gauge& GetGauge (const std::string& name,
+                     const std::string& help,
+                     const std::string& labels = "");
+    Histogram& GetHistogram (const std::string& name,
+                             const std::string& help,
+                             const std::string& labels = "");
+    // output
+    void Write (std::ostream& out);
+    void DisplaySummary ();
+
+private:
+    enum Type {
+        COUNTER, GAUGE, HISTOGRAM
+    };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::vector <std::pair <std::string, std::unique_ptr <Metric>>> series;
+    };
+
+private:
+    Metrics ();
+    Metric& Get (const std::string& name,
+                 const std::string& help,
+                 const std::string& labels,
+                 Type type);
+
+private:
+    // the families are guarded by mutex_, the metrics are not
+    std::mutex mutex_;
+    std::map <std::string, Family> families_;
+};
+
+#endif // METRICS_H_INCLUDED
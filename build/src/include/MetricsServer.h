@@ -0,0 +1,36 @@
+// Description: local scrape endpoint for the metrics registry. A single
+// - thread answers every HTTP request with the Prometheus text of all
+// - metrics, reference Metrics. The endpoint is a localhost TCP port given as
+// - host:port or a Unix socket given as an absolute path, so the metrics are
+// - not exposed past the host unless the configuration asks for it.
+
+#ifndef METRICSSERVER_H_INCLUDED
+#define METRICSSERVER_H_INCLUDED
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+class MetricsServer {
+public:
+    // constructor / destructor
+    MetricsServer (const std::string& listen);
+    virtual ~MetricsServer ();
+    // server methods
+    bool Start ();
+    void Stop ();
+
+private:
+    bool Bind ();
+    void Close ();
+    void Serve ();
+    void Respond (int client);
+
+private:
+    std::string listen_;
+    int fd_;
+    std::atomic <bool> done_;
+    std::thread thread_;
+};
+
+#endif // METRICSSERVER_H_INCLUDED
@@ -2,6 +2,11 @@
 // Description: The operator is used to set the vpp controls based on specified
 // - services. Each services as a formated schedule that dictates the required
 // - inputs for operation. 
+// - The operator runs on the scheduler thread and sends its controls to the
+// - aggregator control channel. SetService and Summary may be called from
+// - any thread and are applied at the start of the next Loop, Summary runs
+// - the next action after it prints so summaries can be chained in order. LoopFER runs
+// - the FER service on its own period and must be on the same thread.
 
 #ifndef OPERATOR_H_INCLUDED
 #define OPERATOR_H_INCLUDED
@@ -10,21 +15,31 @@
 #include <vector>
 #include <map>
 #include "Aggregator.h"
+#include "ControlChannel.h"
+#include "FrequencyDetector.h"
+#include "Metrics.h"
+#include "Schedule.h"
+#include "TimeSource.h"
 
 class Operator {
 public:
 	Operator (
-		std::map <std::string, std::string>& init, Aggregator* vpp_pointer
+		std::map <std::string, std::string>& init,
+		Aggregator* vpp_pointer,
+		TimeSource* clock = TimeSource::System ()
 	);
 	virtual ~Operator ();
 	void Loop ();
+	void LoopFER ();
 	std::string GetTime (time_t utc);
 	void SetService (std::string service);
-	void Summary ();
+	void Summary (ControlChannel::Action next = nullptr);
 
 private: 
 	// class composition
 	Aggregator* vpp_ptr_;
+	TimeSource* clock_;
+	ControlChannel channel_;
 
 	std::map <std::string, std::string> configs_;
 	std::string service_;
@@ -32,21 +47,21 @@ private:
 	bool pdm_control_;
 	bool fer_control_;
 
-	// each schedule will save the last index value to reduce search time
-	unsigned int pjm_a_index_;
-	unsigned int pjm_d_index_;
-	unsigned int eim_index_;
+	// each schedule will save the last row so a control is sent once per row
+	int pjm_a_index_;
+	int pjm_d_index_;
+	int eim_index_;
 	unsigned int tou_index_;
-	unsigned int pdm_index_;
-	unsigned int fer_index_;
+	int pdm_index_;
+	int fer_index_;
 
-	// read service schedules
-	void GetPJMA ();
-	void GetPJMD ();
-	void GetEIM ();
-	void GetTOU ();
-	void GetPDM ();
-	void GetFER ();
+	// read service schedules, called on the thread that sets the service
+	bool GetPJMA (Schedule& schedule);
+	bool GetPJMD (Schedule& schedule);
+	bool GetEIM (Schedule& schedule);
+	bool GetPDM (Schedule& schedule);
+	bool GetFER (Schedule& schedule);
+	int FindRow (const Schedule& schedule, time_t time);
 
 	// service methods.
 	void ServicePJMA ();
@@ -55,61 +70,17 @@ private:
 	void ServiceTOU ();
 	void ServicePDM ();
 	void ServiceFER ();
-
-	// data structures
-    struct RowPJM {
-        std::string time;
-        float normalized_power;
-
-        RowPJM (std::string time, float percent_power)
-            : time(time), normalized_power(percent_power) {
-        };
-    };
-
-    struct RowEIM {
-        std::string time;
-        float normalized_power;
-
-        RowEIM (std::string time, float percent_power)
-            : time(time), normalized_power(percent_power) {
-        };
-    };
-
-    struct RowTOU {
-        std::string time;
-        float real_time_price;
-        float day_ahead_price;
-
-        RowTOU (std::string time, float real_time, float day_ahead)
-            : time(time), real_time_price(real_time), day_ahead_price(day_ahead){
-        };
-    };
-
-    struct RowPDM {
-        std::string time;
-        int temperature;
-
-        RowPDM (std::string time, int Fahrenheit)
-            : time(time), temperature(Fahrenheit) {
-        };
-    };
-
-    struct RowFER {
-        std::string time;
-        float frequency;
-
-        RowFER (std::string time, float hertz)
-            : time(time), frequency(hertz) {
-        };
-    };
+	void FrequencyResponse (const FrequencyEvent& event);
 
 	// schedules
-	std::vector <RowPJM> schedule_pjm_a_;
-	std::vector <RowPJM> schedule_pjm_d_;
-	std::vector <RowEIM> schedule_eim_;
-	std::vector <RowTOU> schedule_tou_;
-	std::vector <RowPDM> schedule_pdm_;
-	std::vector <RowFER> schedule_fer_;
+	// - pjm, eim and fer rows are normalized power or frequency and pdm rows
+	// - are temperature in F. TOU has no schedule, its tiers come from the
+	// - clock, reference ServiceTOU
+	Schedule schedule_pjm_a_;
+	Schedule schedule_pjm_d_;
+	Schedule schedule_eim_;
+	Schedule schedule_pdm_;
+	Schedule schedule_fer_;
 
 	enum Months {
 		JAN, FEB, MAR, APR, MAY, JUN, JUL, AUG, SEP, OCT, NOV, DEC
@@ -120,27 +91,15 @@ private:
 	};
 
 private:
-	float prev_hz_ = 60.0;
-	std::vector <float> prev_freqs_;
-	bool pos_deviation_ = 0;
-	bool neg_deviation_ = 0;
-	bool oneshot0_ = 1;
-	bool oneshot1_ = 1;
-	float event_min_hz_;
-	float event_max_hz_;
-	float event_delta_hz_ = 0;
-	unsigned int event_start_time_;
-	float event_start_hz_;
-	unsigned int event_duration_sec_;
-	bool neg_event_detected_;
-	unsigned int neg_response_start_time_;
-	unsigned int neg_response_sec_;
-	bool neg_response_timer_;
-	bool pos_event_detected_;
-	unsigned int pos_response_start_time_;
-	unsigned int pos_response_sec_;
-	bool pos_response_timer_;
+	// frequency event response, reference FrequencyDetector
+	// - the events are logged to the Frequency log in the aggregator path
+	FrequencyDetector fer_detector_;
 	unsigned int import_power_request_;
+	std::string log_path_;
+
+	// metrics
+	Counter* actions_;
+	Histogram* lookup_time_;
 };
 
 #endif  // OPERATOR_H_INCLUDED
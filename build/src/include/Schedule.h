@@ -0,0 +1,60 @@
+// Description: this class is a service schedule keyed by the seconds of the
+// - day. Each row has a start time and one or more values and stays active
+// - until the next row starts, so a missed second still finds the current
+// - row and the times before the first row belong to the last row of the
+// - previous day. Evenly spaced schedules are looked up directly by index and
+// - irregular schedules with a binary search.
+// - Schedules are read from the CSV files with a streaming parser or from a
+// - compiled binary file written by Save, see tools/schedule_convert.
+//
+// Binary format, native byte order:
+//   char     magic[4]      "DERS"
+//   uint32   version       1
+//   uint32   rows
+//   uint32   columns
+//   uint32   times[rows]   seconds of the day, ascending
+//   float    values[rows * columns]
+
+#ifndef SCHEDULE_H_INCLUDED
+#define SCHEDULE_H_INCLUDED
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+class Schedule {
+public:
+    // constructor / destructor
+    Schedule ();
+    virtual ~Schedule ();
+    // file methods
+    bool Load (const std::string& filename);
+    bool LoadCSV (const std::string& filename);
+    bool LoadBinary (const std::string& filename);
+    bool Save (const std::string& filename);
+    // schedule methods
+    bool Append (unsigned int seconds, const std::vector <float>& values);
+    int Find (unsigned int seconds) const;
+    unsigned int GetTime (unsigned int row) const;
+    float GetValue (unsigned int row, unsigned int column = 0) const;
+    unsigned int Size () const;
+    unsigned int Columns () const;
+    bool Empty () const;
+    void Clear ();
+    void Swap (Schedule& other);
+    // time helpers
+    static unsigned int SecondsOfDay (time_t utc);
+    static std::string FormatTime (unsigned int seconds);
+
+private:
+    bool Index ();
+
+private:
+    std::vector <unsigned int> times_;
+    std::vector <float> values_;
+    unsigned int columns_;
+    // seconds between rows if the schedule is evenly spaced, otherwise 0
+    unsigned int step_;
+};
+
+#endif // SCHEDULE_H_INCLUDED
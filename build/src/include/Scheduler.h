@@ -0,0 +1,78 @@
+// Description: this class runs the control tasks on one event loop thread.
+// - Every task has its own period and the loop sleeps until the earliest
+// - deadline instead of each task sleeping in its own thread. A task that
+// - starts a full period late has missed its deadline, the missed periods are
+// - skipped and counted so a slow tick does not cause a burst of catch up
+// - ticks. The thread can be pinned to a cpu to keep the hot work off the
+// - cores used by AllJoyn and the command workers.
+
+#ifndef SCHEDULER_H_INCLUDED
+#define SCHEDULER_H_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+
+// Task Stats
+// - deadline accounting for a single task, times are in microseconds
+struct TaskStats {
+    std::string name;
+    unsigned int period;        // milliseconds
+    unsigned long runs;         // ticks that ran
+    unsigned long missed;       // periods skipped because the task was late
+    unsigned long overruns;     // ticks that ran longer than the period
+    unsigned long max_late;     // worst start after the deadline
+    unsigned long max_run;      // worst run time
+    unsigned long total_run;    // sum of the run times
+};
+
+class Scheduler {
+public:
+    // tasks are passed the milliseconds since their last run
+    typedef std::function <void (float delta_time)> Task;
+
+    // constructor / destructor
+    Scheduler ();
+    virtual ~Scheduler ();
+    // scheduler methods
+    void AddTask (const std::string& name, unsigned int period, Task task);
+    void Start (int cpu = -1);
+    void Stop ();
+    std::vector <TaskStats> GetStats ();
+    void DisplaySummary ();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        Task task;
+        Clock::duration period;
+        Clock::time_point deadline;
+        Clock::time_point last_run;
+        // deras_task_* metrics labeled by the task name
+        Histogram* run;
+        Histogram* late;
+        Counter* missed;
+    };
+
+private:
+    void Run ();
+    unsigned int Next ();
+
+private:
+    // the entries are only touched by the loop thread once it is started,
+    // the stats and done_ are guarded by mutex_
+    std::vector <Entry> entries_;
+    std::vector <TaskStats> stats_;
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    bool done_;
+    std::thread thread_;
+};
+
+#endif // SCHEDULER_H_INCLUDED
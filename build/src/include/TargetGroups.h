@@ -0,0 +1,43 @@
+// Description: this class interns the target arguments used to filter
+// - resources. Each target string is a group with a membership bitset over
+// - the fleet ids, computed once when the target is first used and kept
+// - current as resources are added and removed. Filtering the fleet is then
+// - an AND of the target bitsets instead of a substring search per path.
+
+#ifndef TARGETGROUPS_H_INCLUDED
+#define TARGETGROUPS_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class TargetGroups {
+public:
+    // constructor / destructor
+    TargetGroups ();
+    virtual ~TargetGroups ();
+    // member methods
+    void Add (const std::string& path);
+    void Remove (unsigned int id);
+    bool IsMember (unsigned int id, const std::vector <std::string>& targets);
+    void Match (const std::vector <std::string>& targets,
+                std::vector <unsigned char>& mask);
+    unsigned int Size ();
+
+private:
+    typedef std::vector <uint64_t> Bitset;
+    unsigned int Intern (const std::string& target);
+    static bool Test (const Bitset& bits, unsigned int id);
+    static void Assign (Bitset& bits, unsigned int id, bool value);
+
+private:
+    // resource paths by fleet id
+    std::vector <std::string> paths_;
+    // target string to group id
+    std::unordered_map <std::string, unsigned int> groups_;
+    std::vector <std::string> targets_;
+    std::vector <Bitset> members_;
+};
+
+#endif // TARGETGROUPS_H_INCLUDED
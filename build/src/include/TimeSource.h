@@ -0,0 +1,35 @@
+// Description: the time source is used by the operator and the aggregator to
+// - read the UTC time. The system time source is the wall clock. The
+// - simulated time source is advanced by the offline simulator so the
+// - schedules can be replayed faster than real time.
+
+#ifndef TIMESOURCE_H_INCLUDED
+#define TIMESOURCE_H_INCLUDED
+
+#include <ctime>
+
+class TimeSource {
+public:
+    virtual ~TimeSource () {};
+    // UTC as seconds from epoch
+    virtual time_t Now () = 0;
+    // the wall clock shared by the program
+    static TimeSource* System ();
+};
+
+class SimulatedTime : public TimeSource {
+public:
+    // constructor / destructor
+    SimulatedTime (time_t start);
+    virtual ~SimulatedTime ();
+    // time methods
+    time_t Now ();
+    void Advance (unsigned int milliseconds);
+    unsigned long long GetElapsed ();
+
+private:
+    time_t start_;
+    unsigned long long elapsed_;  // ms
+};
+
+#endif // TIMESOURCE_H_INCLUDED
@@ -2,43 +2,64 @@
 // Description:
 // 		This class is used to simplify logging. It automatically loads the time
 // 		along with the context, path arguments and then passes all further args
-// 		using the (<<) operator.
+// 		using the (<<) operator. The record is built in place and handed to the
+// 		LogWriter at the end of the line, the file is written in the background.
+//
+//		Components that own a TimeSource pass its time so the stamps and the
+//		date of the file follow the simulated time.
 //
 // Example: 
 // Logger("INFO") << "Data\t" << "More Data";
+// Logger("INFO", path, clock->Now ()) << "Data";
 
 #ifndef LOGGER_H_INCLUDED
 #define LOGGER_H_INCLUDED
 
 // INCLUDES
+#include <ctime>
 #include <string>
 #include <sstream>
+#include "LogWriter.h"
 
 class Logger {
 public:
 	// Constructor/Destructor
-	Logger (std::string context, std::string path);
+	Logger (const std::string& context, const std::string& path);
+	Logger (const std::string& context, const std::string& path, time_t utc);
 	virtual ~Logger ();
 
 	// Operator Overloads
+	// - common types are formatted straight into the record
+	Logger& operator << (const std::string& rhs);
+	Logger& operator << (const char* rhs);
+	Logger& operator << (char rhs);
+	Logger& operator << (int rhs);
+	Logger& operator << (unsigned int rhs);
+	Logger& operator << (long rhs);
+	Logger& operator << (unsigned long rhs);
+	Logger& operator << (float rhs);
+	Logger& operator << (double rhs);
+
+	// - string stream is a simple way to convert any other data type
 	template <typename T>
-	Logger& operator << (T rhs) {
-		// string stream is a simple way to convert any data type into a string
+	Logger& operator << (const T& rhs) {
 	    std::ostringstream ss;
 	    ss << rhs;
-		msg_ += ss.str();
-		return *this;
+		return *this << ss.str();
 	};
 
+	// wait for the background writer to write every record logged so far
+	static void Flush ();
+
 private:
-	std::string msg_;
-	std::string context_;
-	std::string path_;
+	unsigned int sink_;
+	time_t time_;
+	unsigned int length_;
+	char msg_[LogWriter::kTextSize];
 
 private:
-	void ToFile ();
-	std::string GetDate ();
-	std::string GetDateTime ();
+	void Append (const char* text, unsigned int length);
+	void AppendUnsigned (unsigned long value, bool negative);
 };
 
 #endif // LOGGER_H_INCLUDED
@@ -1,48 +1,103 @@
-#include <iostream>
-#include <fstream>
-#include <ctime>
+#include <cstdio>
+#include <cstring>
 #include "include/logger.h"
 
-// the constructor starts the message with DateTime
-Logger::Logger (std::string context, std::string path) 
-	: context_(context), path_(path) {
-	msg_ =  Logger::GetDateTime () + '\t';
+// the constructor takes the time of the record, the writer adds the DateTime
+Logger::Logger (const std::string& context, const std::string& path) 
+	: Logger (context, path, time(0)) {
+}  // end constructor
+
+// the record is stamped with the utc of the caller's time source
+Logger::Logger (const std::string& context,
+				const std::string& path,
+				time_t utc)
+	: sink_(LogWriter::Instance ().GetSink (context, path, ".log")),
+	  time_(utc),
+	  length_(0) {
 }  // end constructor
 
 // becuase the logger object is constructor inline, it is destroyed at the end
-// of the line which then writes the message to the log file.
+// of the line which then passes the message to the log writer.
 Logger::~Logger () {
-	Logger::ToFile ();
+	LogWriter::Instance ().Push (sink_, time_, msg_, length_);
 }  // end destructor
 
-// To File
-// - constructs the filename based on the date and context of the logger
-void Logger::ToFile  () {
-	std::string file_name = path_ + context_ + "_" + Logger::GetDate () 
-		+ ".log";
-	std::ofstream output_file(file_name, std::ios_base::app);
-	if (output_file.is_open()) {
-		output_file << msg_ << '\n';
+Logger& Logger::operator << (const std::string& rhs) {
+	Logger::Append (rhs.data (), rhs.size ());
+	return *this;
+}
+
+Logger& Logger::operator << (const char* rhs) {
+	Logger::Append (rhs, strlen (rhs));
+	return *this;
+}
+
+Logger& Logger::operator << (char rhs) {
+	Logger::Append (&rhs, 1);
+	return *this;
+}
+
+Logger& Logger::operator << (int rhs) {
+	Logger::AppendUnsigned (rhs < 0 ? 0ul - rhs : rhs, rhs < 0);
+	return *this;
+}
+
+Logger& Logger::operator << (unsigned int rhs) {
+	Logger::AppendUnsigned (rhs, false);
+	return *this;
+}
+
+Logger& Logger::operator << (long rhs) {
+	Logger::AppendUnsigned (rhs < 0 ? 0ul - rhs : rhs, rhs < 0);
+	return *this;
+}
+
+Logger& Logger::operator << (unsigned long rhs) {
+	Logger::AppendUnsigned (rhs, false);
+	return *this;
+}
+
+// floating point uses the same format as the default string stream
+Logger& Logger::operator << (float rhs) {
+	return *this << double (rhs);
+}
+
+Logger& Logger::operator << (double rhs) {
+	char buf[32];
+	int length = snprintf (buf, sizeof (buf), "%g", rhs);
+	Logger::Append (buf, length);
+	return *this;
+}
+
+// Flush
+// - used before reading the logs or at the end of a run
+void Logger::Flush () {
+	LogWriter::Instance ().Flush ();
+}  // end Flush
+
+// Append
+// - copy as much of the text as fits, the length keeps counting so the
+// - writer knows the record was truncated
+void Logger::Append (const char* text, unsigned int length) {
+	if (length_ < sizeof (msg_)) {
+		unsigned int space = sizeof (msg_) - length_;
+		memcpy (msg_ + length_, text, length < space ? length : space);
+	}
+	length_ += length;
+}  // end Append
+
+// Append Unsigned
+// - format the digits without a string stream
+void Logger::AppendUnsigned (unsigned long value, bool negative) {
+	char buf[24];
+	char* end = buf + sizeof (buf);
+	char* digit = end;
+	do {
+		*--digit = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	if (negative) {
+		*--digit = '-';
 	}
-	output_file.close();
-}  // end To File
-
-// Get Date
-// - gets the local time date for the file name
-std::string Logger::GetDate () {
-    time_t now = time(0);
-    struct tm ts = *localtime(&now);
-    char buf[100];
-    strftime(buf, sizeof(buf), "%F", &ts);
-    return std::string(buf);
-} // end Get Date
-
-// Get Date Time
-// - gets the local date and time for indexing of the data
-std::string Logger::GetDateTime () {
-    time_t now = time(0);
-    struct tm ts = *localtime(&now);
-    char buf[100];
-    strftime(buf, sizeof(buf), "%F %T", &ts);
-    return std::string(buf);
-} // end Get Date Time
+	Logger::Append (digit, end - digit);
+}  // end Append Unsigned
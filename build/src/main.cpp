@@ -31,8 +31,6 @@
 
 // INCLUDE
 #include <iostream>     // cout, cin
-#include <thread>       // thread, join
-#include <chrono>       // now, duration
 #include <map>
 #include <string>
 #include <vector>
@@ -44,6 +42,8 @@
 #include "include/ClientListener.h"
 #include "include/SmartGridDevice.h"
 #include "include/Operator.h"
+#include "include/Scheduler.h"
+#include "include/MetricsServer.h"
 
 // NAMESPACES
 using namespace std;
@@ -99,87 +99,6 @@ static std::map <std::string, std::string> ArgumentParser (int argc,
     return parameters;
 }  // end Argument Parser
 
-// THREADS
-// -------
-
-// Resource Loop
-// - this loop runs the aggregator control loop at the desired frequency
-// - it subtracks processing time of the Loop () function to make the frequency
-// - more consistant
-void AggregatorLoop (unsigned int sleep, Aggregator* vpp_ptr) {
-    unsigned int time_remaining, time_past;
-    unsigned int time_wait = sleep;
-    auto time_start = chrono::high_resolution_clock::now();
-    auto time_end = chrono::high_resolution_clock::now();
-    chrono::duration<double, milli> time_elapsed;
-
-    while (!done) {
-        time_start = chrono::high_resolution_clock::now();
-            // time since last control call;
-            time_elapsed = time_start - time_end;
-            time_past = time_elapsed.count();
-            vpp_ptr->Loop(time_past);
-        time_end = chrono::high_resolution_clock::now();
-        time_elapsed = time_end - time_start;
-
-        // determine sleep duration after deducting process time
-        if (time_wait - time_elapsed.count() > 0) {
-            time_remaining = time_wait - time_elapsed.count();
-            this_thread::sleep_for (chrono::milliseconds (time_remaining));
-        } 
-    }
-}  // end Aggregator Loop
-
-// Operator Loop
-// - this loop runs the resource control loop at the desired frequency
-// - it subtracks processing time of the Loop () function to make the frequency
-// - more consistant
-void OperatorLoop (unsigned int sleep, Operator* oper_ptr) {
-    unsigned int time_remaining;
-    unsigned int time_wait = sleep;
-    auto time_start = chrono::high_resolution_clock::now();
-    auto time_end = chrono::high_resolution_clock::now();
-    chrono::duration<double, milli> time_elapsed;
-
-    while (!done) {
-        time_start = chrono::high_resolution_clock::now();
-        oper_ptr->Loop();
-        time_end = chrono::high_resolution_clock::now();
-        time_elapsed = time_end - time_start;
-
-        // determine sleep duration after deducting process time
-        if (time_wait - time_elapsed.count() > 0) {
-            time_remaining = time_wait - time_elapsed.count();
-            this_thread::sleep_for (chrono::milliseconds (time_remaining));
-        } 
-    }
-}  // end Resource Loop
-
-// Smart Grid Device Loop
-// - this loop runs the resource control loop at the desired frequency
-// - it subtracks processing time of the Loop () function to make the frequency
-// - more consistant
-void SmartGridDeviceLoop (unsigned int sleep, SmartGridDevice* sgd_ptr) {
-    unsigned int time_remaining;
-    unsigned int time_wait = sleep;
-    auto time_start = chrono::high_resolution_clock::now();
-    auto time_end = chrono::high_resolution_clock::now();
-    chrono::duration<double, milli> time_elapsed;
-
-    while (!done) {
-        time_start = chrono::high_resolution_clock::now();
-        sgd_ptr->Loop();
-        time_end = chrono::high_resolution_clock::now();
-        time_elapsed = time_end - time_start;
-
-        // determine sleep duration after deducting process time
-        if (time_wait - time_elapsed.count() > 0) {
-            time_remaining = time_wait - time_elapsed.count();
-            this_thread::sleep_for (chrono::milliseconds (time_remaining));
-        } 
-    }
-}  // end Resource Loop
-
 // Main
 // ----
 int main (int argc, char** argv) {
@@ -207,9 +126,34 @@ cout
     cout << "\tCreating Operator\n";
     Operator* oper_ptr = new Operator(configs["Operator"], vpp_ptr);
 
+    cout << "\tCreating Scheduler\n";
+    // the control loops run as tasks on one scheduler thread, the operator
+    // runs first so its controls are applied by the aggregator on the same
+    // tick when their periods line up
+    // ~ reference Scheduler.h
+    map <string, string>& periods = configs["Scheduler"];
+    Scheduler scheduler;
+    scheduler.AddTask (
+        "operator", stoul(periods["operator_period"]),
+        [oper_ptr] (float delta_time) { oper_ptr->Loop (); }
+    );
+    scheduler.AddTask (
+        "fer", stoul(periods["fer_period"]),
+        [oper_ptr] (float delta_time) { oper_ptr->LoopFER (); }
+    );
+    scheduler.AddTask (
+        "aggregator", stoul(periods["aggregator_period"]),
+        [vpp_ptr] (float delta_time) { vpp_ptr->Loop (delta_time); }
+    );
+
+    cout << "\tCreating Metrics Server\n";
+    // ~ reference MetricsServer.h
+    MetricsServer metrics_server (configs["Metrics"]["listen"]);
+    metrics_server.Start ();
+
     cout << "\tCreating Command Line Interface\n";
     // ~ reference CommandLineInterface.h
-    CommandLineInterface CLI(vpp_ptr, oper_ptr);
+    CommandLineInterface CLI(vpp_ptr, oper_ptr, &scheduler);
 
     cout << "\tCreating AllJoyn Message Bus\n";
     try {
@@ -292,17 +236,12 @@ cout
     }
     about_ptr->Announce(port, about_data);
 
-    // most objects will have a dedicated thread, but not all
-    cout << "\tSpawning threads...\n";
-    thread VPP (AggregatorLoop, stoul(configs["Threads"]["sleep"]), vpp_ptr);
-
-    thread OPER (
-        OperatorLoop, stoul(configs["Threads"]["sleep"]), oper_ptr
-    );
-
-    thread SGD (
-        SmartGridDeviceLoop, stoul(configs["Threads"]["sleep"]), sgd_ptr
+    cout << "\tStarting scheduler...\n";
+    scheduler.AddTask (
+        "device", stoul(periods["device_period"]),
+        [sgd_ptr] (float delta_time) { sgd_ptr->Loop (); }
     );
+    scheduler.Start (stoi(periods["cpu"]));
 
     // the CLI will control the program and can signal the program to stop
     cout << "Initialization complete...\n";
@@ -318,22 +257,23 @@ cout
     // - dont really explain the shutdown procedure for lots of alljoyn objects
     cout << "Closing program...\n";
 
-    // First join all active threads to main thread
-    cout << "\tJoining threads\n";
-    VPP.join ();
-    OPER.join ();
-    SGD.join ();
+    // First stop the scheduler so no task uses the objects below
+    cout << "\tStopping scheduler\n";
+    scheduler.Stop ();
+    metrics_server.Stop ();
 
     // Then delete all pointers that were created using "new" since they do not
     // automaticall deconstruct at the end of the program.
+    // - the aggregator stops the command queue and waits on the pending
+    // - alljoyn replies, so it is deleted before the bus attachment
     cout << "\nDeleting pointers...\n";
     delete sgd_ptr;
     delete listner_ptr;
     delete obs_ptr;
     delete about_ptr;
-    delete bus_ptr;
     delete oper_ptr;
     delete vpp_ptr;
+    delete bus_ptr;
 
     #ifdef ROUTER
         cout << "\tShutting down AllJoyn Router\n";
@@ -0,0 +1,83 @@
+// Description: benchmark of the command pipeline against the loopback
+// - transport. Every tick the whole fleet gets a new control signal like a
+// - regulation dispatch would send. The time the control loop spends pushing
+// - the commands is shown with the pipeline counters after the queue drains.
+// - A synchronous control loop would have spent resources * latency per tick.
+//
+// Usage: command_bench [resources] [ticks] [latency ms] [endpoints] [loss]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include "../src/include/CommandQueue.h"
+#include "../src/include/LoopbackTransport.h"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+int main (int argc, char** argv) {
+    unsigned int resources = 10000;
+    unsigned int ticks = 20;
+    unsigned int latency = 20;
+    unsigned int endpoints = 64;
+    double loss = 0;
+    if (argc > 1) {
+        resources = std::stoul (argv[1]);
+    }
+    if (argc > 2) {
+        ticks = std::stoul (argv[2]);
+    }
+    if (argc > 3) {
+        latency = std::stoul (argv[3]);
+    }
+    if (argc > 4) {
+        endpoints = std::stoul (argv[4]);
+    }
+    if (argc > 5) {
+        loss = std::stod (argv[5]);
+    }
+
+    LoopbackTransport transport (endpoints, latency, latency / 2, loss);
+    CommandQueue queue (&transport, 2, 1000);
+    std::mt19937 gen (resources);
+    std::uniform_int_distribution <unsigned int> watts (0, 5000);
+
+    // one tick every 100 ms, the default operator rate is slower
+    double push_ms = 0;
+    for (unsigned int tick = 0; tick < ticks; tick++) {
+        Clock::time_point start = Clock::now ();
+        for (unsigned long key = 0; key < resources; key++) {
+            Command command = {key,
+                               tick % 2 ? Command::EXPORT_POWER
+                                        : Command::IMPORT_POWER,
+                               watts (gen)};
+            queue.Push (command);
+        }
+        std::chrono::duration <double, std::milli> time
+            = Clock::now () - start;
+        push_ms += time.count ();
+        std::this_thread::sleep_until (start + std::chrono::milliseconds (100));
+    }
+
+    // wait for the pipeline to drain or time out
+    CommandStats stats = queue.GetStats ();
+    while (stats.pending > 0 || stats.in_flight > 0) {
+        std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        stats = queue.GetStats ();
+    }
+    queue.Stop ();
+
+    std::cout << std::fixed << std::setprecision (3)
+        << "\nresources = " << resources
+        << "\nticks = " << ticks
+        << "\nlatency = " << latency << " ms"
+        << "\nendpoints = " << endpoints
+        << "\npush per tick = " << push_ms / ticks << " ms"
+        << "\nsynchronous per tick = " << double (resources) * latency << " ms"
+        << "\ndelivered = " << transport.GetDeliveredCount ()
+        << "\nlost = " << transport.GetLostCount () << std::endl;
+    queue.DisplaySummary ();
+    return EXIT_SUCCESS;
+}
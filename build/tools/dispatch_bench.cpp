@@ -0,0 +1,264 @@
+// Description: micro benchmark of the aggregator dispatch pass. A synthetic
+// - fleet of detached digital twins is dispatched with a regulation signal
+// - that swings between import and export. The original sort based dispatch
+// - is compared against the DispatchIndex for each fleet size. The cost of
+// - the fleet state twin update is shown for reference. The index buckets
+// - the energy so it may pick other resources within a bucket, the mean
+// - difference of the twin power between the two fleets is shown as a
+// - percent of the rated power. The index is also run with the signal held
+// - to a fixed number of watts so its cost follows the change in watts, not
+// - the fleet size.
+//
+// Usage: dispatch_bench [max fleet size] [ticks]
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+#include "../src/include/DistributedEnergyResource.h"
+#include "../src/include/DispatchIndex.h"
+#include "../src/include/FleetState.h"
+
+typedef std::vector <std::shared_ptr <DistributedEnergyResource>> Fleet;
+typedef std::chrono::high_resolution_clock Clock;
+
+// Make Fleet
+// - water heaters and batteries with a handful of ramp rates and random
+// - amounts of energy available. The seed is fixed so both fleets match.
+static Fleet MakeFleet (FleetState& state, unsigned int size) {
+    std::mt19937 gen (size);
+    std::uniform_int_distribution <unsigned int> type (0, 3);
+    std::uniform_real_distribution <float> fill (0.0, 1.0);
+    Fleet fleet;
+    fleet.reserve (size);
+    state.Reserve (size);
+    for (unsigned int i = 0; i < size; i++) {
+        std::map <std::string, unsigned int> init;
+        if (type (gen) == 0) {
+            // battery
+            init["rated_export_power"] = 5000;
+            init["rated_export_energy"] = 13500;
+            init["export_ramp"] = 5000;
+            init["rated_import_power"] = 5000;
+            init["rated_import_energy"] = 13500;
+            init["import_ramp"] = 5000;
+            init["idle_losses"] = 10;
+        } else {
+            // water heater
+            init["rated_export_power"] = 0;
+            init["rated_export_energy"] = 0;
+            init["export_ramp"] = 0;
+            init["rated_import_power"] = 4500;
+            init["rated_import_energy"] = 4000;
+            init["import_ramp"] = 4500 / (1 + type (gen));
+            init["idle_losses"] = 100;
+        }
+        init["export_energy"] = init["rated_export_energy"] * fill (gen);
+        init["import_energy"] = init["rated_import_energy"] * fill (gen);
+        unsigned int id = state.Add (init);
+        fleet.emplace_back (
+            new DistributedEnergyResource (&state, id, nullptr, id, "", "")
+        );
+    }
+    return fleet;
+}  // end Make Fleet
+
+// Sort Export Power
+// - the original Aggregator::ExportPower
+static void SortExportPower (Fleet& fleet, unsigned int watts) {
+    std::sort(
+        fleet.begin(),fleet.end(), [] (
+        const std::shared_ptr <DistributedEnergyResource> lhs,
+        const std::shared_ptr <DistributedEnergyResource> rhs) {
+        if (lhs->GetExportRamp () != rhs->GetExportRamp ()) {
+            return (lhs->GetExportRamp () > rhs->GetExportRamp ());
+        }
+        return (lhs->GetExportEnergy () > rhs->GetExportEnergy ());
+    });
+
+    unsigned int dispatch_power = watts;
+    unsigned int power = 0;
+    for (auto &resource : fleet) {
+        if (dispatch_power > 0) {
+            power = resource->GetRatedExportPower ();
+            if (resource->GetExportPower () == 0
+                && resource->GetExportWatts () == 0) {
+                resource->RemoteExportPower (power);
+            }
+            dispatch_power = dispatch_power > power ? dispatch_power - power : 0;
+        } else if (resource->GetExportWatts () != 0) {
+            resource->RemoteExportPower (0);
+        }
+    }
+}  // end Sort Export Power
+
+// Sort Import Power
+// - the original Aggregator::ImportPower
+static void SortImportPower (Fleet& fleet, unsigned int watts) {
+    std::sort(
+        fleet.begin(),fleet.end(), [] (
+        const std::shared_ptr <DistributedEnergyResource> lhs,
+        const std::shared_ptr <DistributedEnergyResource> rhs) {
+        if (lhs->GetImportRamp () != rhs->GetImportRamp ()) {
+            return (lhs->GetImportRamp () > rhs->GetImportRamp ());
+        }
+        return (lhs->GetImportEnergy () > rhs->GetImportEnergy ());
+    });
+
+    unsigned int dispatch_power = watts;
+    unsigned int power = 0;
+    for (auto &resource : fleet) {
+        if (dispatch_power > 0) {
+            power = resource->GetRatedImportPower ();
+            if (resource->GetImportPower () == 0
+                && resource->GetImportWatts () == 0) {
+                resource->RemoteImportPower (power);
+            }
+            dispatch_power = dispatch_power > power ? dispatch_power - power : 0;
+        } else if (resource->GetImportWatts () != 0) {
+            resource->RemoteImportPower (0);
+        }
+    }
+}  // end Sort Import Power
+
+// Regulation
+// - normalized regulation signal between -1 (export) and 1 (import), one
+// - period is about 21 ticks so the default run covers both directions
+static float Regulation (unsigned int tick) {
+    return std::sin (tick * 0.3);
+}  // end Regulation
+
+// Bench Fixed
+// - run the index alone with the signal scaled to the same watts for every
+// - fleet size and return the average dispatch milliseconds per tick
+static double BenchFixed (unsigned int size, unsigned int ticks) {
+    const float kDeltaTime = 500;
+    const float kWatts = 1000000;
+    FleetState state;
+    Fleet fleet = MakeFleet (state, size);
+    DispatchIndex index (&state);
+    for (auto &resource : fleet) {
+        index.Insert (resource.get ());
+    }
+    index.Refresh (kDeltaTime);
+
+    std::chrono::duration <double, std::milli> index_time (0);
+    for (unsigned int tick = 0; tick < ticks; tick++) {
+        float signal = Regulation (tick);
+        unsigned int export_watts = signal < 0 ? -signal * kWatts : 0;
+        unsigned int import_watts = signal > 0 ? signal * kWatts : 0;
+        state.Loop (kDeltaTime);
+        auto start = Clock::now ();
+        index.Refresh (kDeltaTime);
+        index.ExportPower (export_watts);
+        index.ImportPower (import_watts);
+        index_time += Clock::now () - start;
+    }
+    return index_time.count () / ticks;
+}  // end Bench Fixed
+
+// Bench
+// - run both dispatch methods over the same fleet and signal and return the
+// - average dispatch milliseconds per tick
+static void Bench (unsigned int size, unsigned int ticks) {
+    const float kDeltaTime = 500;
+    FleetState sorted_state;
+    FleetState indexed_state;
+    Fleet sorted = MakeFleet (sorted_state, size);
+    Fleet indexed = MakeFleet (indexed_state, size);
+    // - a million resources rate more watts than an unsigned int holds
+    double rated_export = 0;
+    double rated_import = 0;
+    for (auto &resource : sorted) {
+        rated_export += resource->GetRatedExportPower ();
+        rated_import += resource->GetRatedImportPower ();
+    }
+
+    DispatchIndex index (&indexed_state);
+    auto start = Clock::now ();
+    for (auto &resource : indexed) {
+        index.Insert (resource.get ());
+    }
+    // - the first refresh sets every timer
+    index.Refresh (kDeltaTime);
+    std::chrono::duration <double, std::milli> build = Clock::now () - start;
+
+    std::chrono::duration <double, std::milli> sort_time (0);
+    std::chrono::duration <double, std::milli> index_time (0);
+    std::chrono::duration <double, std::milli> loop_time (0);
+    double difference = 0;
+    for (unsigned int tick = 0; tick < ticks; tick++) {
+        float signal = Regulation (tick);
+        const double kMaxWatts = std::numeric_limits <unsigned int>::max ();
+        unsigned int export_watts =
+            signal < 0 ? std::min (-signal * rated_export, kMaxWatts) : 0;
+        unsigned int import_watts =
+            signal > 0 ? std::min (signal * rated_import, kMaxWatts) : 0;
+
+        sorted_state.Loop (kDeltaTime);
+        start = Clock::now ();
+        SortExportPower (sorted, export_watts);
+        SortImportPower (sorted, import_watts);
+        sort_time += Clock::now () - start;
+
+        start = Clock::now ();
+        indexed_state.Loop (kDeltaTime);
+        loop_time += Clock::now () - start;
+        start = Clock::now ();
+        index.Refresh (kDeltaTime);
+        index.ExportPower (export_watts);
+        index.ImportPower (import_watts);
+        index_time += Clock::now () - start;
+
+        double power = 0;
+        for (unsigned int id = 0; id < size; id++) {
+            power += sorted_state.import_power[id]
+                   - sorted_state.export_power[id]
+                   - indexed_state.import_power[id]
+                   + indexed_state.export_power[id];
+        }
+        difference += std::fabs (power);
+    }
+
+    std::cout << std::setw (10) << size
+        << std::setw (14) << sort_time.count () / ticks
+        << std::setw (14) << index_time.count () / ticks
+        << std::setw (14) << BenchFixed (size, ticks)
+        << std::setw (14) << build.count ()
+        << std::setw (14) << loop_time.count () / ticks
+        << std::setw (14) << 100 * difference / ticks
+                             / std::max (rated_import, rated_export)
+        << std::endl;
+}  // end Bench
+
+int main (int argc, char** argv) {
+    unsigned int max_size = 1000000;
+    unsigned int ticks = 20;
+    if (argc > 1) {
+        max_size = std::stoul (argv[1]);
+    }
+    if (argc > 2) {
+        ticks = std::stoul (argv[2]);
+    }
+
+    std::cout << "\nDispatch cost per tick (ms)\n"
+        << std::setw (10) << "resources"
+        << std::setw (14) << "sort"
+        << std::setw (14) << "index"
+        << std::setw (14) << "index 1 MW"
+        << std::setw (14) << "index build"
+        << std::setw (14) << "fleet loop"
+        << std::setw (14) << "difference %" << std::endl;
+    std::cout << std::fixed << std::setprecision (3);
+    for (unsigned int size = 1000; size <= max_size; size *= 10) {
+        Bench (size, ticks);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+// Description: backtest the FER frequency event detector on a frequency
+// - schedule. The whole day is pushed through the detector in batch mode and
+// - every start, nadir and recovery is printed with the detector throughput.
+// - A rate above one sample per second interpolates between the rows to
+// - stand in for a PMU stream, the moving average window is scaled with the
+// - rate so it covers the same time. The moving average of the old FER code,
+// - a vector erase and a full sum per sample, is timed on the same stream
+// - for comparison.
+//
+// Usage: fer_backtest [schedule] [samples per second] [config]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/include/tsu.h"
+#include "../src/include/FrequencyDetector.h"
+#include "../src/include/Schedule.h"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Format Time
+// - HH:MM:SS.mmm of the seconds of the day
+static std::string FormatTime (double seconds) {
+    unsigned int whole = seconds;
+    unsigned int millis = (seconds - whole) * 1000 + 0.5;
+    if (millis == 1000) {
+        whole++;
+        millis = 0;
+    }
+    std::ostringstream ss;
+    ss << Schedule::FormatTime (whole) << '.'
+        << std::setw (3) << std::setfill ('0') << millis;
+    return ss.str ();
+}  // end Format Time
+
+// Legacy Average
+// - the moving average of the old FER service, returned so the work is kept
+static double LegacyAverage (const std::vector <float>& hz,
+                             unsigned int window) {
+    std::vector <float> samples (window, 60);
+    double total = 0;
+    for (float sample : hz) {
+        samples.erase (samples.begin ());
+        samples.push_back (sample);
+        total += std::accumulate (samples.begin (), samples.end (), 0.0)
+            / samples.size ();
+    }
+    return total;
+}  // end Legacy Average
+
+int main (int argc, char** argv) {
+    std::string config = "../data/config.ini";
+    if (argc > 3) {
+        config = argv[3];
+    }
+    tsu::config_map configs = tsu::MapConfigFile (config);
+    std::string filename = configs["Operator"]["fer_filepath"];
+    if (argc > 1) {
+        filename = argv[1];
+    }
+    unsigned int rate = 1;
+    if (argc > 2) {
+        rate = std::stoul (argv[2]);
+    }
+    if (rate == 0) {
+        std::cout << "Usage: fer_backtest [schedule] [samples per second] "
+            << "[config]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Schedule schedule;
+    if (!schedule.Load (filename) || schedule.Size () < 2) {
+        std::cout << "[ERROR]...reading " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // build the stream before the run so only the detector is timed
+    std::vector <double> times;
+    std::vector <float> hz;
+    unsigned int rows = schedule.Size ();
+    times.reserve ((schedule.GetTime (rows - 1) - schedule.GetTime (0) + 1)
+                   * rate);
+    hz.reserve (times.capacity ());
+    for (unsigned int i = 0; i + 1 < rows; i++) {
+        double start = schedule.GetTime (i);
+        double span = schedule.GetTime (i + 1) - start;
+        float from = schedule.GetValue (i);
+        float to = schedule.GetValue (i + 1);
+        unsigned int steps = span * rate;
+        for (unsigned int step = 0; step < steps; step++) {
+            double fraction = step / (span * rate);
+            times.push_back (start + fraction * span);
+            hz.push_back (from + (to - from) * fraction);
+        }
+    }
+    times.push_back (schedule.GetTime (rows - 1));
+    hz.push_back (schedule.GetValue (rows - 1));
+
+    FrequencyThresholds thresholds
+        = FrequencyDetector::ReadThresholds (configs["Operator"]);
+    thresholds.window *= rate;
+    FrequencyDetector detector (thresholds);
+
+    const char* types[] = {"start", "nadir", "recovery"};
+    const char* directions[] = {"under", "over"};
+    std::vector <FrequencyEvent> events;
+    events.reserve (1024);
+    detector.SetHandler ([&events] (const FrequencyEvent& event) {
+        events.push_back (event);
+    });
+
+    auto start = Clock::now ();
+    detector.Push (times.data (), hz.data (), times.size ());
+    std::chrono::duration <double> detector_time = Clock::now () - start;
+
+    start = Clock::now ();
+    double check = LegacyAverage (hz, thresholds.window);
+    std::chrono::duration <double> legacy_time = Clock::now () - start;
+
+    std::cout << std::fixed << std::setprecision (4)
+        << std::setw (14) << "time"
+        << std::setw (10) << "event"
+        << std::setw (7) << "dir"
+        << std::setw (10) << "hz"
+        << std::setw (10) << "start hz"
+        << std::setw (16) << "extreme at"
+        << std::setw (12) << "extreme hz" << std::endl;
+    for (const auto &event : events) {
+        std::cout << std::setw (14) << FormatTime (event.time)
+            << std::setw (10) << types[event.type]
+            << std::setw (7) << directions[event.direction]
+            << std::setw (10) << event.hz
+            << std::setw (10) << event.start_hz
+            << std::setw (16) << FormatTime (event.extreme_time)
+            << std::setw (12) << event.extreme_hz << std::endl;
+    }
+
+    double samples = times.size ();
+    double seconds = times.back () - times.front () + 1.0 / rate;
+    std::cout << std::setprecision (1)
+        << "\nSamples = " << times.size ()
+        << " (" << rate << "/s, window " << thresholds.window << ")"
+        << "\nEvents = " << events.size ()
+        << "\nDetector = " << detector_time.count () * 1e9 / samples
+        << " ns/sample, " << samples / detector_time.count ()
+        << " samples/s, " << seconds / detector_time.count ()
+        << "x real time"
+        << "\nLegacy average = " << legacy_time.count () * 1e9 / samples
+        << " ns/sample, " << seconds / legacy_time.count ()
+        << "x real time" << std::endl;
+    // keep the legacy work from being optimized out
+    return check < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+// Description: deterministic offline simulator of the operator and the
+// - aggregator. A synthetic fleet of batteries and water heaters is built
+// - from a fixed seed and a service schedule is replayed on simulated time,
+// - starting at local midnight, as fast as the code runs. Commands go to the
+// - loopback transport and the Data log is off. For each service the report
+// - shows the dispatch tracking error of the digital twins, the latency of
+// - the operator and aggregator tick, the latency of Aggregator::Loop alone
+// - and the throughput. Everything except
+// - the timing and the coalesced commands, which depend on the queue
+// - workers, is the same on every run, so the tool is used as a regression
+// - benchmark and to size the fleet a host can run. The Aggregator::Loop
+// - budget is 1 ms and the fleet sizes it covers are listed in the README.
+//
+// Usage: fleet_sim [service|ALL] [resources] [hours] [tick ms] [config]
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/include/tsu.h"
+#include "../src/include/Aggregator.h"
+#include "../src/include/Operator.h"
+#include "../src/include/TimeSource.h"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Sim Result
+// - the report of one service replay
+struct SimResult {
+    unsigned long ticks;
+    double wall_ms;
+    double simulated_ms;
+    std::vector <double> latency_us;
+    std::vector <double> loop_us;
+    double capacity;
+    double mean_request;
+    double mean_error;
+    double rms_error;
+    double max_error;
+    CommandStats commands;
+};
+
+// Make Fleet
+// - ratings and ramps are drawn from fixed distributions. Half of the water
+// - heaters are tagged as buffer loads for the TOU service.
+static void MakeFleet (Aggregator& vpp, unsigned int size) {
+    std::mt19937 gen (size);
+    std::uniform_int_distribution <unsigned int> type (0, 3);
+    std::uniform_int_distribution <unsigned int> battery_power (3, 7);
+    std::uniform_int_distribution <unsigned int> heater_ramp (1, 4);
+    std::uniform_real_distribution <float> fill (0.1, 0.9);
+    for (unsigned int i = 0; i < size; i++) {
+        std::map <std::string, unsigned int> init;
+        std::string path = "/edu/pdx/powerlab/sep/der/";
+        if (type (gen) == 0) {
+            unsigned int watts = battery_power (gen) * 1000;
+            init["rated_export_power"] = watts;
+            init["rated_export_energy"] = watts * 3;
+            init["export_ramp"] = watts;
+            init["rated_import_power"] = watts;
+            init["rated_import_energy"] = watts * 3;
+            init["import_ramp"] = watts;
+            init["idle_losses"] = 10;
+            path += "battery/";
+        } else {
+            init["rated_export_power"] = 0;
+            init["rated_export_energy"] = 0;
+            init["export_ramp"] = 0;
+            init["rated_import_power"] = 4500;
+            init["rated_import_energy"] = 4000;
+            init["import_ramp"] = 4500 / heater_ramp (gen);
+            init["idle_losses"] = 100;
+            path += (i % 2) ? "water_heater/buffer/" : "water_heater/";
+        }
+        float soc = fill (gen);
+        init["export_energy"] = init["rated_export_energy"] * soc;
+        init["import_energy"] = init["rated_import_energy"] * (1 - soc);
+        vpp.AddResource (init,
+                         ":1." + std::to_string (i),
+                         path + std::to_string (i));
+    }
+}  // end Make Fleet
+
+// Simulate
+// - replay the service for the hours of simulated time
+static SimResult Simulate (tsu::config_map configs,
+                           const std::string& service,
+                           unsigned int resources,
+                           float hours,
+                           unsigned int tick) {
+    // local midnight of the schedule data date
+    struct tm midnight = {};
+    midnight.tm_year = 2019 - 1900;
+    midnight.tm_mon = 3;
+    midnight.tm_mday = 8;
+    midnight.tm_isdst = -1;
+    SimulatedTime clock (mktime (&midnight));
+
+    Aggregator vpp (configs, &clock);
+    Operator oper (configs["Operator"], &vpp, &clock);
+    MakeFleet (vpp, resources);
+    vpp.Loop (0);
+
+    SimResult result = {};
+    result.capacity = std::max (vpp.GetTotalImportPower (),
+                                vpp.GetTotalExportPower ());
+    unsigned long ticks = hours * 3600 * 1000 / tick;
+    result.latency_us.reserve (ticks);
+    result.loop_us.reserve (ticks);
+
+    // the services print to the console, silence them during the replay
+    std::streambuf* console = std::cout.rdbuf (nullptr);
+    oper.SetService (service);
+    double sum_request = 0;
+    double sum_error = 0;
+    double sum_square = 0;
+    Clock::time_point wall = Clock::now ();
+    for (unsigned long i = 0; i < ticks; i++) {
+        Clock::time_point start = Clock::now ();
+        oper.Loop ();
+        oper.LoopFER ();
+        Clock::time_point loop = Clock::now ();
+        vpp.Loop (tick);
+        Clock::time_point end = Clock::now ();
+        std::chrono::duration <double, std::micro> time = end - start;
+        result.latency_us.push_back (time.count ());
+        time = end - loop;
+        result.loop_us.push_back (time.count ());
+
+        // the twins respond to the dispatch of the previous tick
+        double request = double (vpp.GetImportWatts ())
+                       - double (vpp.GetExportWatts ());
+        double actual = double (vpp.GetImportPower ())
+                      - double (vpp.GetExportPower ());
+        double error = std::fabs (request - actual);
+        sum_request += std::fabs (request);
+        sum_error += error;
+        sum_square += error * error;
+        result.max_error = std::max (result.max_error, error);
+        clock.Advance (tick);
+    }
+    std::chrono::duration <double, std::milli> elapsed = Clock::now () - wall;
+    std::cout.rdbuf (console);
+    std::cout.clear ();
+
+    result.ticks = ticks;
+    result.wall_ms = elapsed.count ();
+    result.simulated_ms = clock.GetElapsed ();
+    result.mean_request = ticks ? sum_request / ticks : 0;
+    result.mean_error = ticks ? sum_error / ticks : 0;
+    result.rms_error = ticks ? std::sqrt (sum_square / ticks) : 0;
+    result.commands = vpp.GetCommandStats ();
+    return result;
+}  // end Simulate
+
+// Percentile
+static double Percentile (std::vector <double> values, double percent) {
+    if (values.empty ()) {
+        return 0;
+    }
+    size_t rank = std::min (values.size () - 1,
+                            size_t (percent / 100 * values.size ()));
+    std::nth_element (values.begin (), values.begin () + rank, values.end ());
+    return values[rank];
+}  // end Percentile
+
+// Report
+static void Report (const std::string& service, const SimResult& result) {
+    double seconds = result.wall_ms / 1000;
+    double capacity = result.capacity > 0 ? result.capacity : 1;
+    std::cout << std::setw (6) << service
+        << std::setw (9) << result.ticks
+        << std::setw (10) << seconds
+        << std::setw (9) << result.simulated_ms / result.wall_ms
+        << std::setw (12) << result.ticks / seconds
+        << std::setw (9) << Percentile (result.latency_us, 50)
+        << std::setw (9) << Percentile (result.latency_us, 99)
+        << std::setw (9) << Percentile (result.latency_us, 99.9)
+        << std::setw (10) << Percentile (result.latency_us, 100)
+        << std::setw (10) << Percentile (result.loop_us, 50)
+        << std::setw (10) << Percentile (result.loop_us, 99)
+        << std::setw (11) << result.mean_request
+        << std::setw (11) << result.mean_error
+        << std::setw (8) << 100 * result.rms_error / capacity
+        << std::setw (11) << result.commands.pushed
+        << std::setw (11) << result.commands.coalesced << std::endl;
+}  // end Report
+
+int main (int argc, char** argv) {
+    std::string service = "ALL";
+    unsigned int resources = 1000;
+    float hours = 24;
+    unsigned int tick = 0;
+    std::string config = "../data/config.ini";
+    if (argc > 1) {
+        service = argv[1];
+    }
+    if (argc > 2) {
+        resources = std::stoul (argv[2]);
+    }
+    if (argc > 3) {
+        hours = std::stof (argv[3]);
+    }
+    if (argc > 4) {
+        tick = std::stoul (argv[4]);
+    }
+    if (argc > 5) {
+        config = argv[5];
+    }
+
+    tsu::config_map configs = tsu::MapConfigFile (config);
+    if (tick == 0) {
+        tick = std::stoul (configs["Scheduler"]["aggregator_period"]);
+    }
+    // no remote devices and no Data log, the Property log goes to /tmp
+    configs["Dispatch"]["transport"] = "loopback";
+    configs["Logger"]["increment"] = "0";
+    configs["Logger"]["path"] = "/tmp/fleet_sim_";
+
+    std::vector <std::string> services = {service};
+    if (service == "ALL") {
+        services = {"PJMA", "PJMD", "EIM", "FER"};
+    }
+
+    std::cout << "\nresources = " << resources
+        << "\nhours = " << hours
+        << "\ntick = " << tick << " ms\n\n"
+        << std::setw (6) << "svc"
+        << std::setw (9) << "ticks"
+        << std::setw (10) << "wall s"
+        << std::setw (9) << "speedup"
+        << std::setw (12) << "ticks/s"
+        << std::setw (9) << "p50 us"
+        << std::setw (9) << "p99 us"
+        << std::setw (9) << "p999 us"
+        << std::setw (10) << "max us"
+        << std::setw (10) << "loop p50"
+        << std::setw (10) << "loop p99"
+        << std::setw (11) << "request W"
+        << std::setw (11) << "error W"
+        << std::setw (8) << "rms %"
+        << std::setw (11) << "commands"
+        << std::setw (11) << "coalesced" << std::endl;
+    std::cout << std::fixed << std::setprecision (1);
+    for (const auto &name : services) {
+        Report (name, Simulate (configs, name, resources, hours, tick));
+    }
+    return EXIT_SUCCESS;
+}
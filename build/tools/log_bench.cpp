@@ -0,0 +1,114 @@
+// Description: benchmark of the logger hot path. A Data record like the one
+// - Aggregator::Log writes for every resource is logged N times with the
+// - original open-append-close logger and with the buffered Logger. The cost
+// - is the time on the logging thread, the buffered writer is flushed
+// - separately. The files are written to the given directory.
+//
+// Usage: log_bench [directory] [records]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../src/include/logger.h"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Original Logger
+// - the logger before the background writer
+class OriginalLogger {
+public:
+    OriginalLogger (std::string context, std::string path)
+        : context_(context), path_(path) {
+        msg_ = OriginalLogger::GetDateTime () + '\t';
+    };
+    ~OriginalLogger () {
+        std::string file_name = path_ + context_ + "_"
+            + OriginalLogger::GetDate () + ".log";
+        std::ofstream output_file (file_name, std::ios_base::app);
+        if (output_file.is_open ()) {
+            output_file << msg_ << '\n';
+        }
+        output_file.close ();
+    };
+    template <typename T>
+    OriginalLogger& operator << (T rhs) {
+        std::ostringstream ss;
+        ss << rhs;
+        msg_ += ss.str ();
+        return *this;
+    };
+
+private:
+    std::string GetDate () {
+        time_t now = time (0);
+        struct tm ts = *localtime (&now);
+        char buf[100];
+        strftime (buf, sizeof (buf), "%F", &ts);
+        return std::string (buf);
+    };
+    std::string GetDateTime () {
+        time_t now = time (0);
+        struct tm ts = *localtime (&now);
+        char buf[100];
+        strftime (buf, sizeof (buf), "%F %T", &ts);
+        return std::string (buf);
+    };
+
+private:
+    std::string msg_;
+    std::string context_;
+    std::string path_;
+};
+
+int main (int argc, char** argv) {
+    std::string path = "/tmp/";
+    unsigned int records = 100000;
+    if (argc > 1) {
+        path = argv[1];
+        if (path.back () != '/') {
+            path += '/';
+        }
+    }
+    if (argc > 2) {
+        records = std::stoul (argv[2]);
+    }
+
+    const std::string uid = ":1.42";
+    const std::string der_path = "/edu/pdx/powerlab/sep/der/battery/1042";
+
+    Clock::time_point start = Clock::now ();
+    for (unsigned int i = 0; i < records; i++) {
+        OriginalLogger ("BenchOriginal", path)
+            << uid << '\t' << der_path << '\t'
+            << i % 5000 << '\t' << 4200u << '\t' << 13500u << '\t'
+            << 0u << '\t' << 0u << '\t' << i % 13500;
+    }
+    std::chrono::duration <double, std::nano> original = Clock::now () - start;
+
+    start = Clock::now ();
+    for (unsigned int i = 0; i < records; i++) {
+        Logger ("BenchBuffered", path)
+            << uid << '\t' << der_path << '\t'
+            << i % 5000 << '\t' << 4200u << '\t' << 13500u << '\t'
+            << 0u << '\t' << 0u << '\t' << i % 13500;
+    }
+    std::chrono::duration <double, std::nano> buffered = Clock::now () - start;
+    Logger::Flush ();
+    std::chrono::duration <double, std::nano> flushed = Clock::now () - start;
+
+    LogStats stats = LogWriter::Instance ().GetStats ();
+    std::cout << std::fixed << std::setprecision (1)
+        << "\nrecords = " << records
+        << "\noriginal = " << original.count () / records << " ns/record"
+        << "\nbuffered = " << buffered.count () / records << " ns/record"
+        << "\nbuffered with flush = " << flushed.count () / records
+        << " ns/record"
+        << "\nwrites = " << stats.writes
+        << "\nstalls = " << stats.stalls
+        << "\nerrors = " << stats.errors << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+// Description: compile a service schedule into the binary schedule format
+// - read by the Operator. The input is one of the data/schedules CSV files or
+// - a CAISO interchange schedule XML read with xml2schedule. XML intervals
+// - are keyed by their local start time of day and a gap between intervals
+// - is filled with a zero row. The output is read back and compared before
+// - the tool reports success.
+//
+// Usage: schedule_convert <input.csv | input.xml> <output>
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "../src/include/SetPoint.h"
+#include "../src/include/xml2schedule.h"
+#include "../src/include/Schedule.h"
+
+// Is XML
+// - decide the input type by the file extension
+static bool IsXML (const std::string& filename) {
+    std::string::size_type dot = filename.rfind ('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = filename.substr (dot + 1);
+    return extension == "xml" || extension == "XML";
+}  // end Is XML
+
+// Load XML
+// - convert the CAISO set points into schedule rows
+static bool LoadXML (const std::string& filename, Schedule& schedule) {
+    std::vector <SetPoint> points;
+    try {
+        points = xml2schedule (filename);
+    } catch (const std::exception& e) {
+        std::cout << "[ERROR]...reading xml: " << e.what () << std::endl;
+        return false;
+    }
+
+    // later intervals replace earlier ones that start at the same time
+    std::map <unsigned int, float> rows;
+    for (const auto &point : points) {
+        rows[Schedule::SecondsOfDay (point.startDateTime)] = point.value1;
+    }
+    for (const auto &point : points) {
+        rows.emplace (Schedule::SecondsOfDay (point.endDateTime), 0);
+    }
+
+    schedule.Clear ();
+    for (const auto &row : rows) {
+        schedule.Append (row.first, {row.second});
+    }
+    return !schedule.Empty ();
+}  // end Load XML
+
+int main (int argc, char** argv) {
+    if (argc != 3) {
+        std::cout << "Usage: schedule_convert <input.csv | input.xml> <output>"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    Schedule schedule;
+    bool loaded = IsXML (input) ? LoadXML (input, schedule)
+                                : schedule.LoadCSV (input);
+    if (!loaded || !schedule.Save (output)) {
+        return EXIT_FAILURE;
+    }
+
+    // read the output back and compare every row
+    Schedule check;
+    if (!check.LoadBinary (output)
+        || check.Size () != schedule.Size ()
+        || check.Columns () != schedule.Columns ()) {
+        std::cout << "[ERROR]...verify failed: " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (unsigned int row = 0; row < schedule.Size (); row++) {
+        bool same = check.GetTime (row) == schedule.GetTime (row);
+        for (unsigned int col = 0; col < schedule.Columns (); col++) {
+            same = same && check.GetValue (row, col)
+                           == schedule.GetValue (row, col);
+        }
+        if (!same) {
+            std::cout << "[ERROR]...verify failed at row " << row << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << input << " -> " << output
+        << "\n\trows = " << schedule.Size ()
+        << "\n\tcolumns = " << schedule.Columns ()
+        << "\n\tfirst = " << Schedule::FormatTime (schedule.GetTime (0))
+        << "\n\tlast = "
+        << Schedule::FormatTime (schedule.GetTime (schedule.Size () - 1))
+        << std::endl;
+    return EXIT_SUCCESS;
+}